@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=../main.c ../canargb_events.c ../canargb_leds.c ../canargb_nvs.c ../../VLCBlib_PIC/boot.c ../../VLCBlib_PIC/can18_can_2.c ../../VLCBlib_PIC/event_consumer_simple.c ../../VLCBlib_PIC/event_teach_simple.c ../../VLCBlib_PIC/messageQueue.c ../../VLCBlib_PIC/mns.c ../../VLCBlib_PIC/nv.c ../../VLCBlib_PIC/nvm.c ../../VLCBlib_PIC/statusLeds2.c ../../VLCBlib_PIC/ticktime.c ../../VLCBlib_PIC/timedResponse.c ../../VLCBlib_PIC/vlcb.c
+SOURCEFILES_QUOTED_IF_SPACED=../main.c ../canargb_events.c ../canargb_leds.c ../canargb_nvs.c ../canargb_service.c ../canargb_flash.c ../canargb_timers.c ../canargb_readback.c ../canargb_dispatch.c ../canargb_layers.c ../canargb_journal.c ../canargb_filter.c ../canargb_bench.c ../../VLCBlib_PIC/boot.c ../../VLCBlib_PIC/can18_can_2.c ../../VLCBlib_PIC/event_consumer_simple.c ../../VLCBlib_PIC/event_teach_simple.c ../../VLCBlib_PIC/messageQueue.c ../../VLCBlib_PIC/mns.c ../../VLCBlib_PIC/nv.c ../../VLCBlib_PIC/nvm.c ../../VLCBlib_PIC/statusLeds2.c ../../VLCBlib_PIC/ticktime.c ../../VLCBlib_PIC/timedResponse.c ../../VLCBlib_PIC/vlcb.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1472/main.p1 ${OBJECTDIR}/_ext/1472/canargb_events.p1 ${OBJECTDIR}/_ext/1472/canargb_leds.p1 ${OBJECTDIR}/_ext/1472/canargb_nvs.p1 ${OBJECTDIR}/_ext/1954642981/boot.p1 ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1 ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1 ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1 ${OBJECTDIR}/_ext/1954642981/messageQueue.p1 ${OBJECTDIR}/_ext/1954642981/mns.p1 ${OBJECTDIR}/_ext/1954642981/nv.p1 ${OBJECTDIR}/_ext/1954642981/nvm.p1 ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1 ${OBJECTDIR}/_ext/1954642981/ticktime.p1 ${OBJECTDIR}/_ext/1954642981/timedResponse.p1 ${OBJECTDIR}/_ext/1954642981/vlcb.p1
-POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1472/main.p1.d ${OBJECTDIR}/_ext/1472/canargb_events.p1.d ${OBJECTDIR}/_ext/1472/canargb_leds.p1.d ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d ${OBJECTDIR}/_ext/1954642981/boot.p1.d ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1.d ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1.d ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1.d ${OBJECTDIR}/_ext/1954642981/messageQueue.p1.d ${OBJECTDIR}/_ext/1954642981/mns.p1.d ${OBJECTDIR}/_ext/1954642981/nv.p1.d ${OBJECTDIR}/_ext/1954642981/nvm.p1.d ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1.d ${OBJECTDIR}/_ext/1954642981/ticktime.p1.d ${OBJECTDIR}/_ext/1954642981/timedResponse.p1.d ${OBJECTDIR}/_ext/1954642981/vlcb.p1.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/_ext/1472/main.p1 ${OBJECTDIR}/_ext/1472/canargb_events.p1 ${OBJECTDIR}/_ext/1472/canargb_leds.p1 ${OBJECTDIR}/_ext/1472/canargb_nvs.p1 ${OBJECTDIR}/_ext/1472/canargb_service.p1 ${OBJECTDIR}/_ext/1472/canargb_flash.p1 ${OBJECTDIR}/_ext/1472/canargb_timers.p1 ${OBJECTDIR}/_ext/1472/canargb_readback.p1 ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 ${OBJECTDIR}/_ext/1472/canargb_layers.p1 ${OBJECTDIR}/_ext/1472/canargb_journal.p1 ${OBJECTDIR}/_ext/1472/canargb_filter.p1 ${OBJECTDIR}/_ext/1472/canargb_bench.p1 ${OBJECTDIR}/_ext/1954642981/boot.p1 ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1 ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1 ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1 ${OBJECTDIR}/_ext/1954642981/messageQueue.p1 ${OBJECTDIR}/_ext/1954642981/mns.p1 ${OBJECTDIR}/_ext/1954642981/nv.p1 ${OBJECTDIR}/_ext/1954642981/nvm.p1 ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1 ${OBJECTDIR}/_ext/1954642981/ticktime.p1 ${OBJECTDIR}/_ext/1954642981/timedResponse.p1 ${OBJECTDIR}/_ext/1954642981/vlcb.p1
+POSSIBLE_DEPFILES=${OBJECTDIR}/_ext/1472/main.p1.d ${OBJECTDIR}/_ext/1472/canargb_events.p1.d ${OBJECTDIR}/_ext/1472/canargb_leds.p1.d ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d ${OBJECTDIR}/_ext/1472/canargb_service.p1.d ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d ${OBJECTDIR}/_ext/1954642981/boot.p1.d ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1.d ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1.d ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1.d ${OBJECTDIR}/_ext/1954642981/messageQueue.p1.d ${OBJECTDIR}/_ext/1954642981/mns.p1.d ${OBJECTDIR}/_ext/1954642981/nv.p1.d ${OBJECTDIR}/_ext/1954642981/nvm.p1.d ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1.d ${OBJECTDIR}/_ext/1954642981/ticktime.p1.d ${OBJECTDIR}/_ext/1954642981/timedResponse.p1.d ${OBJECTDIR}/_ext/1954642981/vlcb.p1.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/_ext/1472/main.p1 ${OBJECTDIR}/_ext/1472/canargb_events.p1 ${OBJECTDIR}/_ext/1472/canargb_leds.p1 ${OBJECTDIR}/_ext/1472/canargb_nvs.p1 ${OBJECTDIR}/_ext/1954642981/boot.p1 ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1 ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1 ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1 ${OBJECTDIR}/_ext/1954642981/messageQueue.p1 ${OBJECTDIR}/_ext/1954642981/mns.p1 ${OBJECTDIR}/_ext/1954642981/nv.p1 ${OBJECTDIR}/_ext/1954642981/nvm.p1 ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1 ${OBJECTDIR}/_ext/1954642981/ticktime.p1 ${OBJECTDIR}/_ext/1954642981/timedResponse.p1 ${OBJECTDIR}/_ext/1954642981/vlcb.p1
+OBJECTFILES=${OBJECTDIR}/_ext/1472/main.p1 ${OBJECTDIR}/_ext/1472/canargb_events.p1 ${OBJECTDIR}/_ext/1472/canargb_leds.p1 ${OBJECTDIR}/_ext/1472/canargb_nvs.p1 ${OBJECTDIR}/_ext/1472/canargb_service.p1 ${OBJECTDIR}/_ext/1472/canargb_flash.p1 ${OBJECTDIR}/_ext/1472/canargb_timers.p1 ${OBJECTDIR}/_ext/1472/canargb_readback.p1 ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 ${OBJECTDIR}/_ext/1472/canargb_layers.p1 ${OBJECTDIR}/_ext/1472/canargb_journal.p1 ${OBJECTDIR}/_ext/1472/canargb_filter.p1 ${OBJECTDIR}/_ext/1472/canargb_bench.p1 ${OBJECTDIR}/_ext/1954642981/boot.p1 ${OBJECTDIR}/_ext/1954642981/can18_can_2.p1 ${OBJECTDIR}/_ext/1954642981/event_consumer_simple.p1 ${OBJECTDIR}/_ext/1954642981/event_teach_simple.p1 ${OBJECTDIR}/_ext/1954642981/messageQueue.p1 ${OBJECTDIR}/_ext/1954642981/mns.p1 ${OBJECTDIR}/_ext/1954642981/nv.p1 ${OBJECTDIR}/_ext/1954642981/nvm.p1 ${OBJECTDIR}/_ext/1954642981/statusLeds2.p1 ${OBJECTDIR}/_ext/1954642981/ticktime.p1 ${OBJECTDIR}/_ext/1954642981/timedResponse.p1 ${OBJECTDIR}/_ext/1954642981/vlcb.p1
 
 # Source Files
-SOURCEFILES=../main.c ../canargb_events.c ../canargb_leds.c ../canargb_nvs.c ../../VLCBlib_PIC/boot.c ../../VLCBlib_PIC/can18_can_2.c ../../VLCBlib_PIC/event_consumer_simple.c ../../VLCBlib_PIC/event_teach_simple.c ../../VLCBlib_PIC/messageQueue.c ../../VLCBlib_PIC/mns.c ../../VLCBlib_PIC/nv.c ../../VLCBlib_PIC/nvm.c ../../VLCBlib_PIC/statusLeds2.c ../../VLCBlib_PIC/ticktime.c ../../VLCBlib_PIC/timedResponse.c ../../VLCBlib_PIC/vlcb.c
+SOURCEFILES=../main.c ../canargb_events.c ../canargb_leds.c ../canargb_nvs.c ../canargb_service.c ../canargb_flash.c ../canargb_timers.c ../canargb_readback.c ../canargb_dispatch.c ../canargb_layers.c ../canargb_journal.c ../canargb_filter.c ../canargb_bench.c ../../VLCBlib_PIC/boot.c ../../VLCBlib_PIC/can18_can_2.c ../../VLCBlib_PIC/event_consumer_simple.c ../../VLCBlib_PIC/event_teach_simple.c ../../VLCBlib_PIC/messageQueue.c ../../VLCBlib_PIC/mns.c ../../VLCBlib_PIC/nv.c ../../VLCBlib_PIC/nvm.c ../../VLCBlib_PIC/statusLeds2.c ../../VLCBlib_PIC/ticktime.c ../../VLCBlib_PIC/timedResponse.c ../../VLCBlib_PIC/vlcb.c
 
 
 
@@ -120,6 +120,78 @@ ${OBJECTDIR}/_ext/1472/canargb_nvs.p1: ../canargb_nvs.c  nbproject/Makefile-${CN
 	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_nvs.d ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/_ext/1472/canargb_bench.p1: ../canargb_bench.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_bench.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_bench.p1 ../canargb_bench.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_bench.d ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_filter.p1: ../canargb_filter.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_filter.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_filter.p1 ../canargb_filter.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_filter.d ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_journal.p1: ../canargb_journal.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_journal.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_journal.p1 ../canargb_journal.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_journal.d ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_layers.p1: ../canargb_layers.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_layers.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_layers.p1 ../canargb_layers.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_layers.d ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_dispatch.p1: ../canargb_dispatch.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 ../canargb_dispatch.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_dispatch.d ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_readback.p1: ../canargb_readback.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_readback.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_readback.p1 ../canargb_readback.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_readback.d ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_timers.p1: ../canargb_timers.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_timers.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_timers.p1 ../canargb_timers.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_timers.d ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_flash.p1: ../canargb_flash.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_flash.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_flash.p1 ../canargb_flash.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_flash.d ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_service.p1: ../canargb_service.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_service.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_service.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -mdebugger=pickit5   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_service.p1 ../canargb_service.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_service.d ${OBJECTDIR}/_ext/1472/canargb_service.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_service.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 ${OBJECTDIR}/_ext/1954642981/boot.p1: ../../VLCBlib_PIC/boot.c  nbproject/Makefile-${CND_CONF}.mk 
 	@${MKDIR} "${OBJECTDIR}/_ext/1954642981" 
 	@${RM} ${OBJECTDIR}/_ext/1954642981/boot.p1.d 
@@ -249,6 +321,78 @@ ${OBJECTDIR}/_ext/1472/canargb_nvs.p1: ../canargb_nvs.c  nbproject/Makefile-${CN
 	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_nvs.d ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_nvs.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/_ext/1472/canargb_bench.p1: ../canargb_bench.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_bench.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_bench.p1 ../canargb_bench.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_bench.d ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_bench.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_filter.p1: ../canargb_filter.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_filter.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_filter.p1 ../canargb_filter.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_filter.d ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_filter.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_journal.p1: ../canargb_journal.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_journal.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_journal.p1 ../canargb_journal.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_journal.d ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_journal.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_layers.p1: ../canargb_layers.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_layers.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_layers.p1 ../canargb_layers.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_layers.d ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_layers.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_dispatch.p1: ../canargb_dispatch.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1 ../canargb_dispatch.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_dispatch.d ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_dispatch.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_readback.p1: ../canargb_readback.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_readback.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_readback.p1 ../canargb_readback.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_readback.d ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_readback.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_timers.p1: ../canargb_timers.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_timers.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_timers.p1 ../canargb_timers.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_timers.d ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_timers.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_flash.p1: ../canargb_flash.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_flash.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_flash.p1 ../canargb_flash.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_flash.d ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_flash.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/_ext/1472/canargb_service.p1: ../canargb_service.c  nbproject/Makefile-${CND_CONF}.mk 
+	@${MKDIR} "${OBJECTDIR}/_ext/1472" 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_service.p1.d 
+	@${RM} ${OBJECTDIR}/_ext/1472/canargb_service.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c   -mdfp="${DFP_DIR}/xc8"  -fno-short-double -fno-short-float -memi=wordwrite -mrom=0800-FFFF -O0 -fasmfile -maddrqual=ignore -xassembler-with-cpp -I"../" -I"../../VLCB-defs" -I"../../VLCBlib_PIC" -mwarn=-3 -Wa,-a -DXPRJ_default=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx32 -Wl,--data-init -mno-keep-startup -mno-download -mno-default-config-bits $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto:auto     -o ${OBJECTDIR}/_ext/1472/canargb_service.p1 ../canargb_service.c 
+	@-${MV} ${OBJECTDIR}/_ext/1472/canargb_service.d ${OBJECTDIR}/_ext/1472/canargb_service.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/_ext/1472/canargb_service.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 ${OBJECTDIR}/_ext/1954642981/boot.p1: ../../VLCBlib_PIC/boot.c  nbproject/Makefile-${CND_CONF}.mk 
 	@${MKDIR} "${OBJECTDIR}/_ext/1954642981" 
 	@${RM} ${OBJECTDIR}/_ext/1954642981/boot.p1.d 
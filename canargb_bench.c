@@ -0,0 +1,223 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB throughput benchmark.
+ * The operations measured are a full repaint after a palette change, a 
+ * single range update, a flash toggle and the decoding of the first event in
+ * the event table. Rendering is measured as the CPU time spent in pollRender()
+ * until the frame is ready to send, so the time waiting for the string to 
+ * finish the previous frame isn't included. The achieved frame rate with a 
+ * full repaint of every frame is measured over one second.
+ * The timed decodes aren't journalled and any delayed instructions they 
+ * schedule are discarded.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "can.h"
+#include "event_teach.h"
+#include "ticktime.h"
+#include "canargb_bench.h"
+#include "canargb_leds.h"
+#include "canargb_events.h"
+#include "canargb_service.h"
+#include "canargb_journal.h"
+#include "canargb_timers.h"
+
+static void startTimer(void);
+static uint16_t readTimer(void);
+static uint16_t timeRender(void);
+static void waitOutputIdle(void);
+static void record(uint8_t diagnostic, uint32_t halfMicroseconds);
+static void sendResult(uint8_t diagnostic);
+
+/**
+ * Run each benchmark and report the results.
+ */
+void runBenchmark(void) {
+    uint8_t i;
+    uint8_t tableIndex;
+    uint32_t total;
+    uint16_t frames;
+    TickValue start;
+    Message m;
+    
+    // TMR1 counts Fosc/4 with a 1:8 prescale, 0.5us per count
+    T1CLK = 0x01;
+    T1CON = 0x33;
+    
+    // let anything outstanding finish
+    timeRender();
+    
+    // full repaint, the palette is resolved again and every LED rendered
+    total = 0;
+    for (i=0; i<BENCH_REPEATS; i++) {
+        selectPaletteBank(paletteBank());
+        total += timeRender();
+    }
+    record(CANARGB_DIAG_BENCH_REPAINT_TIME, total);
+    
+    // a single range update
+    total = 0;
+    for (i=0; i<BENCH_REPEATS; i++) {
+        startTimer();
+        updateLedRange(i, i+9, (PaletteIndex)(uint8_t)(i & 0x0F));
+        updateRGB();
+        total += readTimer();
+        total += timeRender();
+    }
+    record(CANARGB_DIAG_BENCH_RANGE_TIME, total);
+    
+    // flash toggle
+    total = 0;
+    for (i=0; i<BENCH_REPEATS; i++) {
+        doFlash();
+        total += timeRender();
+    }
+    record(CANARGB_DIAG_BENCH_FLASH_TIME, total);
+    
+    // event decode of the first event in the table, 0xFFFF if none taught
+    for (tableIndex=0; tableIndex<NUM_EVENTS; tableIndex++) {
+        if (getEN(tableIndex) != 0) break;
+    }
+    if (tableIndex < NUM_EVENTS) {
+        m.opc = OPC_ACON;
+        m.len = 5;
+        m.bytes[0] = (uint8_t)(getNN(tableIndex) >> 8);
+        m.bytes[1] = (uint8_t)getNN(tableIndex);
+        m.bytes[2] = (uint8_t)(getEN(tableIndex) >> 8);
+        m.bytes[3] = (uint8_t)getEN(tableIndex);
+        // the decodes mustn't be journalled or leave delayed instructions behind
+        journalSuspend(TRUE);
+        total = 0;
+        for (i=0; i<BENCH_REPEATS; i++) {
+            startTimer();
+            APP_processConsumedEvent(tableIndex, &m);
+            total += readTimer();
+        }
+        journalSuspend(FALSE);
+        initTimers();
+        record(CANARGB_DIAG_BENCH_DECODE_TIME, total);
+        timeRender();
+    } else {
+        canargbDiagnostics[CANARGB_DIAG_BENCH_DECODE_TIME].asUint = 0xFFFF;
+    }
+    
+    // frames per second with a full repaint for each frame
+    frames = 0;
+    start.val = tickGet();
+    while (tickTimeSince(start) < ONE_SECOND) {
+        selectPaletteBank(paletteBank());
+        timeRender();
+        refreshString();
+        frames++;
+    }
+    canargbDiagnostics[CANARGB_DIAG_BENCH_FRAME_RATE].asUint = frames;
+    
+    for (i=CANARGB_DIAG_BENCH_FRAME_RATE; i<=CANARGB_DIAG_BENCH_DECODE_TIME; i++) {
+        sendResult(i);
+    }
+}
+
+/**
+ * Run pollRender() until the frame has been rendered and copied to the frame
+ * buffer, timing just the calls to pollRender(). Any previous frame is sent 
+ * first, outside the timing, so that every timed call does rendering work
+ * rather than waiting for the string.
+ * @return the time in 0.5us units
+ */
+static uint16_t timeRender(void) {
+    uint32_t total;
+    
+    waitOutputIdle();
+    total = 0;
+    while ( ! renderComplete()) {
+        startTimer();
+        pollRender();
+        total += readTimer();
+    }
+    return (total > 0xFFFF) ? 0xFFFF : (uint16_t)total;
+}
+
+/**
+ * Send any frame waiting in the frame buffer and wait for the string to 
+ * finish.
+ */
+static void waitOutputIdle(void) {
+    refreshString();
+    while (outputBusy())
+        ;
+}
+
+static void startTimer(void) {
+    TMR1H = 0;
+    TMR1L = 0;
+}
+
+static uint16_t readTimer(void) {
+    uint8_t lo;
+    
+    lo = TMR1L;     // reading TMR1L latches TMR1H
+    return ((uint16_t)TMR1H << 8) | lo;
+}
+
+/**
+ * Record the average of BENCH_REPEATS measurements in us.
+ * @param diagnostic the diagnostic index
+ * @param halfMicroseconds the total of the measurements in TMR1 counts
+ */
+static void record(uint8_t diagnostic, uint32_t halfMicroseconds) {
+    halfMicroseconds /= (2*BENCH_REPEATS);
+    canargbDiagnostics[diagnostic].asUint = (halfMicroseconds > 0xFFFF) ? 0xFFFF : (uint16_t)halfMicroseconds;
+}
+
+/**
+ * Send a result as if it had been requested using RDGN.
+ * @param diagnostic the diagnostic index
+ */
+static void sendResult(uint8_t diagnostic) {
+    Message m;
+    
+    m.opc = OPC_DGN;
+    m.len = 7;
+    m.bytes[0] = nn.bytes.hi;
+    m.bytes[1] = nn.bytes.lo;
+    m.bytes[2] = findServiceIndex(SERVICE_ID_CANARGB);
+    m.bytes[3] = diagnostic;
+    m.bytes[4] = canargbDiagnostics[diagnostic].asBytes.hi;
+    m.bytes[5] = canargbDiagnostics[diagnostic].asBytes.lo;
+    canTransport.sendMessage(&m);
+}
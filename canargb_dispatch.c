@@ -0,0 +1,221 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB prioritised message dispatch.
+ * Each queue is a ring buffer of received messages along with the time they
+ * were taken from the CAN receive FIFO so that the time spent queued can be
+ * reported.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "can.h"
+#include "ticktime.h"
+#include "canargb_dispatch.h"
+#include "canargb_service.h"
+#include "canargb_filter.h"
+#include "canargb_flash.h"
+
+typedef struct {
+    Message message;
+    TickValue arrival;
+} QueuedMessage;
+
+static QueuedMessage eventQueue[DISPATCH_EVENT_QUEUE];
+static QueuedMessage configQueue[DISPATCH_CONFIG_QUEUE];
+static uint8_t eventHead;
+static uint8_t eventTail;
+static uint8_t configHead;
+static uint8_t configTail;
+static uint8_t eventsSinceConfig;
+static TickValue lastArrival;
+
+static SendResult dispatchSend(Message * m);
+static MessageReceived dispatchReceive(Message * m);
+static void dispatchWaitForTxQueueToDrain(void);
+static void fillQueues(void);
+static void takeMessage(QueuedMessage * q, Message * m, uint32_t * stat);
+static uint8_t isPriority(Message * m);
+static void updateHighWater(void);
+
+const Transport dispatchTransport = {
+    dispatchSend,
+    dispatchReceive,
+    dispatchWaitForTxQueueToDrain
+};
+
+/**
+ * Empty the queues.
+ */
+void initDispatch(void) {
+    eventHead = eventTail = 0;
+    configHead = configTail = 0;
+    eventsSinceConfig = 0;
+}
+
+/**
+ * Check whether there are received messages waiting to be processed.
+ * @return TRUE if either queue has a message
+ */
+uint8_t dispatchPending(void) {
+    return (eventHead != eventTail) || (configHead != configTail);
+}
+
+/**
+ * Get the time the message last returned to the library was taken from the 
+ * CAN receive FIFO, for measurements which mustn't include the time queued.
+ * @return the arrival time
+ */
+TickValue dispatchArrival(void) {
+    return lastArrival;
+}
+
+/**
+ * Transmission is unchanged.
+ * @param m the message to send
+ * @return the result from the CAN transport
+ */
+static SendResult dispatchSend(Message * m) {
+    return canTransport.sendMessage(m);
+}
+
+static void dispatchWaitForTxQueueToDrain(void) {
+    canTransport.waitForTxQueueToDrain();
+}
+
+/**
+ * Get the next message for the library to process. Events are returned ahead 
+ * of configuration messages unless configuration messages have waited for
+ * DISPATCH_STARVATION_LIMIT events.
+ * 
+ * @param m where to put the message
+ * @return RECEIVED if a message was returned
+ */
+static MessageReceived dispatchReceive(Message * m) {
+    uint8_t haveEvent;
+    uint8_t haveConfig;
+    
+    fillQueues();
+    haveEvent = (eventHead != eventTail);
+    haveConfig = (configHead != configTail);
+    
+    if (haveConfig && ( ! haveEvent || (eventsSinceConfig >= DISPATCH_STARVATION_LIMIT))) {
+        takeMessage(&configQueue[configTail], m, &statsConfigQueueTime);
+        configTail = (configTail+1) & (DISPATCH_CONFIG_QUEUE-1);
+        eventsSinceConfig = 0;
+        return RECEIVED;
+    }
+    if (haveEvent) {
+        takeMessage(&eventQueue[eventTail], m, &statsEventQueueTime);
+        eventTail = (eventTail+1) & (DISPATCH_EVENT_QUEUE-1);
+        if (haveConfig) {
+            eventsSinceConfig++;
+        }
+        return RECEIVED;
+    }
+    return NOT_RECEIVED;
+}
+
+/**
+ * Move messages from the CAN receive FIFO into the queues. Draining stops 
+ * whilst either queue is full, as the class of the next message isn't known
+ * until it has been read, leaving the remainder in the CAN receive FIFO.
+ */
+static void fillQueues(void) {
+    uint8_t eventNext;
+    uint8_t configNext;
+    Message * m;
+    
+    for (;;) {
+        eventNext = (eventHead+1) & (DISPATCH_EVENT_QUEUE-1);
+        configNext = (configHead+1) & (DISPATCH_CONFIG_QUEUE-1);
+        if ((eventNext == eventTail) || (configNext == configTail)) return;
+        
+        // read straight into the event slot and move it if it is configuration
+        m = &(eventQueue[eventHead].message);
+        if (canTransport.receiveMessage(m) != RECEIVED) return;
+        if (eventFilterRejects(m)) continue;
+        if (isPriority(m)) {
+            eventQueue[eventHead].arrival.val = tickGet();
+            eventHead = eventNext;
+        } else {
+            configQueue[configHead].message = *m;
+            configQueue[configHead].arrival.val = tickGet();
+            configHead = configNext;
+        }
+        updateHighWater();
+    }
+}
+
+/**
+ * Events and flash sync messages go in the event queue.
+ * @param m the received message
+ * @return TRUE if the message goes in the event queue
+ */
+static uint8_t isPriority(Message * m) {
+    if (isEvent(m->opc)) return TRUE;
+    return (m->opc == OPC_ACDAT) && (m->len >= 4) && (m->bytes[2] == FLASH_SYNC_MARKER);
+}
+
+/**
+ * Record the most messages waiting in the queues.
+ */
+static void updateHighWater(void) {
+    uint8_t waiting;
+    
+    waiting = ((eventHead - eventTail) & (DISPATCH_EVENT_QUEUE-1)) 
+            + ((configHead - configTail) & (DISPATCH_CONFIG_QUEUE-1));
+    if (waiting > canargbDiagnostics[CANARGB_DIAG_RX_HIGH_WATER].asUint) {
+        canargbDiagnostics[CANARGB_DIAG_RX_HIGH_WATER].asUint = waiting;
+    }
+}
+
+/**
+ * Copy a message out of a queue and record how long it waited.
+ * @param q the queue entry
+ * @param m where to put the message
+ * @param stat the longest wait this second in ticks
+ */
+static void takeMessage(QueuedMessage * q, Message * m, uint32_t * stat) {
+    uint32_t waited;
+    
+    *m = q->message;
+    lastArrival = q->arrival;
+    waited = tickTimeSince(q->arrival);
+    if (waited > *stat) {
+        *stat = waited;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB prioritised message dispatch.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_DISPATCH_H_
+#define _CANARGB_DISPATCH_H_
+
+#include "vlcb.h"
+#include "ticktime.h"
+
+/*
+ * The dispatch transport sits between the library and the CAN transport. 
+ * Received messages are drained from the CAN receive FIFO into an event queue
+ * and a configuration queue and events are handed to the library first. After
+ * DISPATCH_STARVATION_LIMIT events in a row a waiting configuration message 
+ * is taken so that configuration traffic is never held up indefinitely.
+ * Events which can't be in the event table are dropped before being queued.
+ * Flash sync messages are queued with the events so that the sync timing isn't
+ * held up behind other configuration messages.
+ */
+#define DISPATCH_EVENT_QUEUE        16      // must be a power of 2
+#define DISPATCH_CONFIG_QUEUE       8       // must be a power of 2
+#define DISPATCH_STARVATION_LIMIT   8
+
+extern const Transport dispatchTransport;
+extern void initDispatch(void);
+extern uint8_t dispatchPending(void);
+extern TickValue dispatchArrival(void);
+
+#endif
@@ -40,14 +40,45 @@
 #include "module.h"
 #include "event_teach.h"
 #include "mns.h"
+#include "ticktime.h"
 #include "canargb_events.h"
 #include "canargb_leds.h"
+#include "canargb_service.h"
+#include "canargb_nvs.h"
+#include "canargb_flash.h"
+#include "canargb_timers.h"
+#include "canargb_readback.h"
+#include "canargb_layers.h"
+#include "canargb_journal.h"
+#include "canargb_filter.h"
 
-#define ACTION_ON_MASK      0x01
-#define ACTION_OFF_MASK     0x02
+/*
+ * Event table layout used for the block read of the EVs and for writing a 
+ * new event in one go. Each row holds the Event, a flags byte and then the EVs.
+ */
+#define EVENT_ROW_SIZE      (sizeof(Event) + 1 + PARAM_NUM_EV_EVENT)
+#define EVENT_ROW_NN        0
+#define EVENT_ROW_EN        2
+#define EVENT_ROW_FLAGS     sizeof(Event)
+#define EVENT_ROW_EVS       (sizeof(Event) + 1)
 
 // forward declarations
 extern void clearAllEvents(void);
+extern uint8_t errno;
+static uint8_t validateInstructions(uint8_t * instructions);
+static uint8_t clipRange(uint16_t start, uint16_t end, uint8_t * localStart, uint8_t * localEnd);
+static uint8_t writeNewEvent(void);
+
+/*
+ * The bulk teach buffer. Holds all the EVs of the event currently being taught.
+ */
+static uint8_t teachEvs[PARAM_NUM_EV_EVENT];
+static uint16_t teachNodeNumber;
+static uint16_t teachEventNumber;
+static Boolean teachPending;
+static uint8_t teachCount;
+static TickValue teachStartTime;
+static TickValue teachLastTime;
 
 
 void factoryResetGlobalEvents(void) {
@@ -66,12 +97,26 @@ uint8_t APP_isConsumedEvent(uint8_t tableIndex) {
 }
 
 /**
- * No special handling is required.
+ * Any buffered bulk teach is committed before a message which may observe or
+ * change the event table is processed. Flash sync messages are handled here
+ * and palette NVSETs are staged so they can be committed together.
  * 
  * @param m
  */
 Processed APP_preProcessMessage(Message * m) {
-    return NOT_PROCESSED;
+    if (teachPending && (m->opc != OPC_EVLRN)) {
+        if (isEvent(m->opc) || (m->opc == OPC_EVULN) || (m->opc == OPC_REQEV) ||
+                ((m->len >= 3) && (m->bytes[0] == nn.bytes.hi) && (m->bytes[1] == nn.bytes.lo))) {
+            commitEventTeach();
+        }
+    }
+    if ( ! isEvent(m->opc)) {
+        // the library may write to NVM whilst processing the message
+        journalWaitIdle();
+    }
+    if (flashSyncPreProcess(m) == PROCESSED) return PROCESSED;
+    if (readbackPreProcess(m) == PROCESSED) return PROCESSED;
+    return paletteNvPreProcess(m);
 }
 /**
  * This application doesn't need to process any messages in a special way.
@@ -81,17 +126,193 @@ Processed APP_postProcessMessage(Message * m) {
 }
 
 /**
- * No need for special handling.
+ * Taught EVs are collected in the bulk teach buffer rather than being written
+ * to flash one at a time. The whole instruction block is written by 
+ * commitEventTeach(). Teaches passed straight to the library commit any 
+ * buffered teach first.
  * 
  * @param nodeNumber
  * @param eventNumber
  * @param evNum
  * @param evVal
  * @param forceOwnNN
- * @return 
+ * @return the index into the event table or 0xff if the event is not yet in the table
  */
 uint8_t APP_addEvent(uint16_t nodeNumber, uint16_t eventNumber, uint8_t evNum, uint8_t evVal, Boolean forceOwnNN) {
-    return addEvent(nodeNumber, eventNumber, evNum, evVal, forceOwnNN);
+    uint8_t tableIndex;
+    uint8_t i;
+    
+    if (forceOwnNN || (evNum >= PARAM_NUM_EV_EVENT)) {
+        // keep the writes in the order they were requested
+        commitEventTeach();
+        return addEvent(nodeNumber, eventNumber, evNum, evVal, forceOwnNN);
+    }
+    if (teachPending && ((nodeNumber != teachNodeNumber) || (eventNumber != teachEventNumber))) {
+        commitEventTeach();
+    }
+    tableIndex = findEvent(nodeNumber, eventNumber);
+    if (! teachPending) {
+        // start a new block with the existing EVs, if any
+        if (tableIndex == 0xff) {
+            for (tableIndex=0; tableIndex<NUM_EVENTS; tableIndex++) {
+                if (getEN(tableIndex) == 0) break;
+            }
+            if (tableIndex >= NUM_EVENTS) {
+                errno = CMDERR_TOO_MANY_EVENTS;
+                return 0xff;
+            }
+            for (i=0; i<PARAM_NUM_EV_EVENT; i++) {
+                teachEvs[i] = EV_FILL;
+            }
+            tableIndex = 0xff;
+        } else {
+            readEventEVs(tableIndex, evs);
+            for (i=0; i<PARAM_NUM_EV_EVENT; i++) {
+                teachEvs[i] = evs[i];
+            }
+        }
+        teachNodeNumber = nodeNumber;
+        teachEventNumber = eventNumber;
+        teachCount = 0;
+        teachStartTime.val = tickGet();
+        teachPending = TRUE;
+    }
+    teachEvs[evNum] = evVal;
+    teachCount++;
+    teachLastTime.val = tickGet();
+    errno = 0;
+    return tableIndex;
+}
+
+/**
+ * Commit the buffered bulk teach if there has been no EVLRN for a while.
+ */
+void pollEventTeach(void) {
+    if (teachPending && (tickTimeSince(teachLastTime) > TEACH_COMMIT_TIMEOUT)) {
+        commitEventTeach();
+    }
+}
+
+/**
+ * Validate the buffered instructions and write them to the event table. 
+ * The EVs, and the row header of a new event, are written into the flash 
+ * block buffer and then flushed so that each flash block spanned by the event
+ * is written at most once.
+ * Errors are reported using CMDERR and GRSP as there is no outstanding request
+ * to respond to.
+ */
+void commitEventTeach(void) {
+    uint8_t tableIndex;
+    uint8_t evNum;
+    uint32_t elapsed;
+    
+    if (! teachPending) return;
+    teachPending = FALSE;
+    invalidateEventFilter();
+    
+    if (validateInstructions(teachEvs)) {
+        canargbDiagnostics[CANARGB_DIAG_TEACH_ERRORS].asUint++;
+        sendMessage3(OPC_CMDERR, nn.bytes.hi, nn.bytes.lo, CMDERR_INV_EV_VALUE);
+        sendMessage5(OPC_GRSP, nn.bytes.hi, nn.bytes.lo, OPC_EVLRN, SERVICE_ID_OLD_TEACH, CMDERR_INV_EV_VALUE);
+        return;
+    }
+    tableIndex = findEvent(teachNodeNumber, teachEventNumber);
+    if (tableIndex == 0xff) {
+        if (writeNewEvent()) {
+            sendMessage3(OPC_CMDERR, nn.bytes.hi, nn.bytes.lo, CMDERR_TOO_MANY_EVENTS);
+            sendMessage5(OPC_GRSP, nn.bytes.hi, nn.bytes.lo, OPC_EVLRN, SERVICE_ID_OLD_TEACH, CMDERR_TOO_MANY_EVENTS);
+            return;
+        }
+    } else {
+        for (evNum=0; evNum<PARAM_NUM_EV_EVENT; evNum++) {
+            writeEv(tableIndex, evNum, teachEvs[evNum]);
+        }
+        flushFlashBlock();
+    }
+    
+    elapsed = teachLastTime.val - teachStartTime.val + 1;
+    canargbDiagnostics[CANARGB_DIAG_TEACH_EVS].asUint = teachCount;
+    canargbDiagnostics[CANARGB_DIAG_TEACH_RATE].asUint = (uint16_t)(((uint32_t)teachCount * ONE_SECOND) / elapsed);
+}
+
+/**
+ * Write the buffered event into a free row of the event table. addEvent() 
+ * would write and flush the row header before the EVs were written so the 
+ * whole row, header and EVs, is written into the flash block buffer here and
+ * flushed once.
+ * 
+ * @return 0 on success otherwise 1 if the event table is full
+ */
+static uint8_t writeNewEvent(void) {
+    uint8_t tableIndex;
+    uint8_t evNum;
+    uint24_t address;
+    
+    for (tableIndex=0; tableIndex<NUM_EVENTS; tableIndex++) {
+        if (getEN(tableIndex) == 0) break;
+    }
+    if (tableIndex >= NUM_EVENTS) return 1;
+    
+    address = EVENT_TABLE_ADDRESS + (uint24_t)EVENT_ROW_SIZE*tableIndex;
+    // high byte first, as addEvent() stores them
+    writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_NN, (uint8_t)(teachNodeNumber >> 8));
+    writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_NN + 1, (uint8_t)teachNodeNumber);
+    writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_EN, (uint8_t)(teachEventNumber >> 8));
+    writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_EN + 1, (uint8_t)teachEventNumber);
+    writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_FLAGS, 0);
+    for (evNum=0; evNum<PARAM_NUM_EV_EVENT; evNum++) {
+        writeNVM(FLASH_NVM_TYPE, address + EVENT_ROW_EVS + evNum, teachEvs[evNum]);
+    }
+    flushFlashBlock();
+#ifdef EVENT_HASH_TABLE
+    rebuildHashtable();
+#endif
+    return 0;
+}
+
+/**
+ * Check that the list of instructions is something we can execute.
+ * Unused instructions have an action of NO_ACTION.
+ * 
+ * @param instructions the EVs for the event
+ * @return 0 if valid otherwise the offset+1 of the first invalid instruction
+ */
+static uint8_t validateInstructions(uint8_t * instructions) {
+    uint8_t ev;
+    
+    for (ev=0; ev<EVperEVT; ev+=4) {
+        uint8_t action = instructions[ev];
+        
+        if (action == NO_ACTION) continue;
+        switch (action & ACTION_OPCODE_MASK) {
+            case ACTION_SET_RANGE:
+            case ACTION_CLEAR_LAYER:
+                // reversed ranges are allowed, they are clamped to the start LED
+                break;
+            case ACTION_RANGE_HIGH:
+                if (action & ACTION_LAYER_MASK) return ev+1;
+                // must be followed by an LED instruction
+                if (ev+4 >= EVperEVT) return ev+1;
+                if ((instructions[ev+4] == NO_ACTION) ||
+                        (((instructions[ev+4] & ACTION_OPCODE_MASK) != ACTION_SET_RANGE) &&
+                        ((instructions[ev+4] & ACTION_OPCODE_MASK) != ACTION_CLEAR_LAYER))) return ev+1;
+                break;
+            case ACTION_SELECT_BANK:
+                if (action & ACTION_LAYER_MASK) return ev+1;
+                if (instructions[ev+1] >= NUM_PALETTE_BANKS) return ev+1;
+                break;
+            case ACTION_DELAY:
+                if (action & ACTION_LAYER_MASK) return ev+1;
+                // must be followed by an instruction to delay
+                if (ev+4 >= EVperEVT) return ev+1;
+                if ((instructions[ev+4] == NO_ACTION) || 
+                        ((instructions[ev+4] & ACTION_OPCODE_MASK) == ACTION_DELAY)) return ev+1;
+                break;
+            default:
+                return ev+1;
+        }
+    }
+    return 0;
 }
 
 /**
@@ -105,33 +326,154 @@ uint8_t APP_addEvent(uint16_t nodeNumber, uint16_t eventNumber, uint8_t evNum, u
 Processed APP_processConsumedEvent(uint8_t tableIndex, Message *m) {
     uint8_t ev;
     uint8_t onOff;
+    uint16_t delay;
+    uint8_t startHigh;
+    uint8_t endHigh;
+    uint8_t start;
+    uint8_t end;
+    TickValue startTime;
+    uint32_t t;
     
+    startTime.val = tickGet();
+    statsEventCount++;
     onOff = !(m->opc & 1);
-    if (getEVs(tableIndex)) {   
+    if (readEventEVs(tableIndex, evs)) {   
         // something went wrong
         return PROCESSED;
     }
 
+    delay = 0;
+    startHigh = 0;
+    endHigh = 0;
     for(ev=0; ev<EVperEVT; ev+=4) {
         uint8_t action;
-        uint8_t start_ledno;
-        uint8_t end_ledno;
-        PaletteIndex colourPixelIndexPair;
         
         action = evs[ev];
-        start_ledno = evs[ev+1];
-        end_ledno = evs[ev+2];
-        colourPixelIndexPair.asByte = evs[ev+3];
-        
-        if (onOff && (action & ACTION_ON_MASK)) {
-            updateLedRange(start_ledno, end_ledno, colourPixelIndexPair);
-        }
-        if (!onOff && (action & ACTION_OFF_MASK)) {
-            updateLedRange(start_ledno, end_ledno, colourPixelIndexPair);
+        if ((onOff && (action & ACTION_ON_MASK)) || (!onOff && (action & ACTION_OFF_MASK))) {
+            switch (action & ACTION_OPCODE_MASK) {
+                case ACTION_DELAY:
+                    delay = ((uint16_t)evs[ev+1] << 8) | evs[ev+2];
+                    continue;
+                case ACTION_RANGE_HIGH:
+                    startHigh = evs[ev+1];
+                    endHigh = evs[ev+2];
+                    continue;
+                case ACTION_SET_RANGE:
+                case ACTION_CLEAR_LAYER:
+                    if ( ! clipRange(((uint16_t)startHigh << 8) | evs[ev+1], ((uint16_t)endHigh << 8) | evs[ev+2], &start, &end)) {
+                        // none of the range is on this node
+                        action = NO_ACTION;
+                    }
+                    break;
+                default:
+                    start = evs[ev+1];
+                    end = evs[ev+2];
+                    break;
+            }
+            if (action == NO_ACTION) {
+                // nothing to do
+            } else if (delay == 0) {
+                performInstruction(action, start, end, evs[ev+3]);
+            } else if ( ! scheduleInstruction(delay, action, start, end, evs[ev+3])) {
+                // no room so do it now rather than lose it
+                performInstruction(action, start, end, evs[ev+3]);
+            }
         }
+        delay = 0;
+        startHigh = 0;
+        endHigh = 0;
     }
     updateRGB();
+    t = tickTimeSince(startTime);
+    if (t > statsDecodeTime) statsDecodeTime = t;
     return PROCESSED;
 }
 
+/**
+ * Convert a global LED range to this node's LEDs. The node's LEDs are global
+ * LED numbers NV_GLOBAL_BASE to NV_GLOBAL_BASE+MAX_LEDS-1. With a base of 0
+ * the global and local LED numbers are the same.
+ * Within the node's 256 LED numbers the range is clamped as updateLedRange()
+ * does, so a reversed range is just the start LED and a start beyond the last 
+ * LED is the last LED. Ranges starting in another node's LED numbers are 
+ * ignored.
+ * 
+ * @param start the global start LED
+ * @param end the global end LED
+ * @param localStart where to put the first local LED
+ * @param localEnd where to put the last local LED
+ * @return FALSE if none of the range is on this node
+ */
+static uint8_t clipRange(uint16_t start, uint16_t end, uint8_t * localStart, uint8_t * localEnd) {
+    uint16_t base;
+    
+    base = ((uint16_t)getNV(NV_GLOBAL_BASE_HI) << 8) | (uint8_t)getNV(NV_GLOBAL_BASE_LO);
+    if (end < start) end = start;
+    if (end < base) return FALSE;
+    if (start < base) start = base;
+    // offsets from the base so that the top of the global space doesn't wrap
+    start -= base;
+    end -= base;
+    if (start > 0xFF) return FALSE;
+    if (start > MAX_LEDS-1) start = MAX_LEDS-1;
+    if (end > MAX_LEDS-1) end = MAX_LEDS-1;
+    *localStart = (uint8_t)start;
+    *localEnd = (uint8_t)end;
+    return TRUE;
+}
+
+/**
+ * Perform a single instruction.
+ * 
+ * @param action the action EV, the opcode is in the upper nibble and the layer in bits 2 and 3
+ * @param start the start LED or the palette bank
+ * @param end the end LED
+ * @param colour the colour pair
+ */
+void performInstruction(uint8_t action, uint8_t start, uint8_t end, uint8_t colour) {
+    journalInstruction(action, start, end, colour);
+    switch (action & ACTION_OPCODE_MASK) {
+        case ACTION_SET_RANGE:
+            setLayerRange((action & ACTION_LAYER_MASK) >> ACTION_LAYER_SHIFT, start, end, colour);
+            break;
+        case ACTION_CLEAR_LAYER:
+            clearLayerRange((action & ACTION_LAYER_MASK) >> ACTION_LAYER_SHIFT, start, end);
+            break;
+        case ACTION_SELECT_BANK:
+            selectPaletteBank(start);
+            break;
+    }
+}
+
+/**
+ * Read all the EVs of an event into a buffer using sequential table reads rather
+ * than a readNVM() per EV. The flash cache is flushed first so that the flash
+ * holds any EVs which have been written but not yet committed.
+ * 
+ * @param tableIndex the index of the event in the event table
+ * @param buffer where to put the PARAM_NUM_EV_EVENT EVs
+ * @return 0 on success otherwise the error code
+ */
+uint8_t readEventEVs(uint8_t tableIndex, uint8_t * buffer) {
+    uint24_t address;
+    uint8_t * p;
+    uint8_t n;
+    
+    if (tableIndex >= NUM_EVENTS) {
+        return CMDERR_INV_EN_IDX;
+    }
+    flushFlashBlock();
+    
+    address = EVENT_TABLE_ADDRESS + (uint24_t)EVENT_ROW_SIZE*tableIndex + EVENT_ROW_EVS;
+    TBLPTRU = (uint8_t)(address >> 16);
+    TBLPTRH = (uint8_t)(address >> 8);
+    TBLPTRL = (uint8_t)address;
+    p = buffer;
+    for (n=PARAM_NUM_EV_EVENT; n>0; n--) {
+        asm("TBLRD*+");
+        *p++ = TABLAT;
+    }
+    return 0;
+}
+
 
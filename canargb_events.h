@@ -37,3 +37,41 @@
  * 
  */
 
+#ifndef _CANARGB_EVENTS_H_
+#define _CANARGB_EVENTS_H_
+
+#include "vlcb.h"
+
+/*
+ * Bulk teach.
+ * Whilst in learn mode the EVs taught for an event are collected in RAM and
+ * are only written to the event table once all the EVs have been received.
+ * The buffered EVs are committed when an EV for a different event is taught,
+ * when a message which could observe the event table is received or after
+ * TEACH_COMMIT_TIMEOUT with no further EVLRN. 
+ */
+#define TEACH_COMMIT_TIMEOUT    ONE_SECOND
+
+/*
+ * The first EV of each instruction is the action. The lower bits select whether
+ * the instruction is performed for the ON and/or OFF event, bits 2 and 3 are
+ * the layer for the LED instructions and the upper nibble is the instruction 
+ * opcode.
+ */
+#define ACTION_ON_MASK      0x01
+#define ACTION_OFF_MASK     0x02
+#define ACTION_LAYER_MASK   0x0C
+#define ACTION_LAYER_SHIFT  2
+#define ACTION_OPCODE_MASK  0xF0
+#define ACTION_SET_RANGE    0x00    // set LEDs start..end to the colour pair
+#define ACTION_SELECT_BANK  0x10    // switch to palette bank given by the second EV
+#define ACTION_DELAY        0x20    // delay the next instruction by the second and third EVs in 100ms units
+#define ACTION_CLEAR_LAYER  0x30    // remove LEDs start..end from the layer
+#define ACTION_RANGE_HIGH   0x40    // high bytes of the global start and end LED numbers of the next instruction
+
+extern void pollEventTeach(void);
+extern void commitEventTeach(void);
+extern uint8_t readEventEVs(uint8_t tableIndex, uint8_t * buffer);
+extern void performInstruction(uint8_t action, uint8_t start, uint8_t end, uint8_t colour);
+
+#endif
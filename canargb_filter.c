@@ -0,0 +1,180 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB foreign event filter.
+ * Each event sets 2 bits of the filter, using 2 different hashes of its node
+ * number and event number. With 255 events the false positive rate is about 5%.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "event_teach.h"
+#include "canargb_filter.h"
+#include "canargb_service.h"
+#include "canargb_journal.h"
+
+// short event opcodes have this bit set and are stored with a node number of 0
+#define FILTER_SHORT_EVENT      0x08
+// learn mode bit of mode_flags
+#define FILTER_FLAG_LEARN       0x01
+
+extern uint8_t mode_flags;
+
+static uint8_t filter[FILTER_BITS/8];
+static uint8_t filterValid;
+static uint8_t rebuildPos;
+static uint8_t rebuilding;
+static uint16_t filterNodeNumber;   // the node number when the filter was built
+
+static uint16_t hash(uint16_t a, uint16_t b);
+static void addToFilter(uint16_t nodeNumber, uint16_t eventNumber);
+static uint8_t inFilter(uint16_t nodeNumber, uint16_t eventNumber);
+
+/**
+ * Start building the filter.
+ */
+void initEventFilter(void) {
+    invalidateEventFilter();
+}
+
+/**
+ * Mark the filter as out of date. Called when the event table may have been
+ * changed.
+ */
+void invalidateEventFilter(void) {
+    filterValid = FALSE;
+    rebuilding = FALSE;
+}
+
+/**
+ * Rebuild the filter a chunk at a time when it is out of date.
+ */
+void pollEventFilter(void) {
+    uint16_t i;
+    uint8_t end;
+    
+    if (nn.word != filterNodeNumber) {
+        // events taught with our own node number are now stored differently
+        filterNodeNumber = nn.word;
+        invalidateEventFilter();
+    }
+    if (mode_flags & FILTER_FLAG_LEARN) {
+        // events may be taught at any time
+        invalidateEventFilter();
+        return;
+    }
+    if (filterValid) return;
+    if (journalBusy()) return;      // leave NVM alone whilst the journal is writing
+    if ( ! rebuilding) {
+        for (i=0; i<sizeof(filter); i++) {
+            filter[i] = 0;
+        }
+        rebuildPos = 0;
+        rebuilding = TRUE;
+    }
+    end = (rebuildPos > NUM_EVENTS - FILTER_REBUILD_CHUNK) ? NUM_EVENTS : rebuildPos + FILTER_REBUILD_CHUNK;
+    // unused entries are added too, they can only cause false positives
+    for (; rebuildPos < end; rebuildPos++) {
+        addToFilter(getNN(rebuildPos), getEN(rebuildPos));
+    }
+    if (rebuildPos >= NUM_EVENTS) {
+        rebuilding = FALSE;
+        filterValid = TRUE;
+    }
+}
+
+/**
+ * Check whether a received message is an event which can't be in the event
+ * table.
+ * @param m the received message
+ * @return TRUE if the message should be dropped
+ */
+uint8_t eventFilterRejects(Message * m) {
+    Word nodeNumber;
+    Word eventNumber;
+    
+    if ( ! filterValid) return FALSE;
+    if (nn.word != filterNodeNumber) return FALSE;
+    if (m->len < 5) return FALSE;
+    if ( ! isEvent(m->opc)) return FALSE;
+    
+    if (m->opc & FILTER_SHORT_EVENT) {
+        nodeNumber.word = 0;
+    } else {
+        nodeNumber.bytes.hi = m->bytes[0];
+        nodeNumber.bytes.lo = m->bytes[1];
+    }
+    eventNumber.bytes.hi = m->bytes[2];
+    eventNumber.bytes.lo = m->bytes[3];
+    if (inFilter(nodeNumber.word, eventNumber.word)) {
+        statsFilterPasses++;
+        return FALSE;
+    }
+    statsFilterRejects++;
+    return TRUE;
+}
+
+/**
+ * Mix two 16 bit values into a filter bit number.
+ */
+static uint16_t hash(uint16_t a, uint16_t b) {
+    uint16_t h;
+    
+    h = (uint16_t)(a * 0x9E37) ^ b;
+    h ^= h >> 7;
+    h = (uint16_t)(h * 0x5BD1);
+    h ^= h >> 8;
+    return h & (FILTER_BITS-1);
+}
+
+static void addToFilter(uint16_t nodeNumber, uint16_t eventNumber) {
+    uint16_t bit;
+    
+    bit = hash(nodeNumber, eventNumber);
+    filter[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+    bit = hash(eventNumber, nodeNumber);
+    filter[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+}
+
+static uint8_t inFilter(uint16_t nodeNumber, uint16_t eventNumber) {
+    uint16_t bit;
+    
+    bit = hash(nodeNumber, eventNumber);
+    if ((filter[bit >> 3] & (uint8_t)(1 << (bit & 7))) == 0) return FALSE;
+    bit = hash(eventNumber, nodeNumber);
+    if ((filter[bit >> 3] & (uint8_t)(1 << (bit & 7))) == 0) return FALSE;
+    return TRUE;
+}
@@ -0,0 +1,63 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB foreign event filter.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_FILTER_H_
+#define _CANARGB_FILTER_H_
+
+#include "vlcb.h"
+
+/*
+ * Events received from the bus are checked against a Bloom filter of the 
+ * events in the event table before being queued for the library. An event 
+ * which isn't in the filter can't be in the table so it is dropped without
+ * going through the service dispatch and hash lookup. An event which is in
+ * the filter may still not be in the table.
+ * 
+ * The filter is rebuilt from the event table, FILTER_REBUILD_CHUNK entries per
+ * poll, whenever the table or the node number may have changed. Whilst in 
+ * learn mode or rebuilding every event is passed to the library.
+ */
+#define FILTER_BITS             2048    // must be a power of 2
+#define FILTER_REBUILD_CHUNK    32
+
+extern void initEventFilter(void);
+extern void pollEventFilter(void);
+extern void invalidateEventFilter(void);
+extern uint8_t eventFilterRejects(Message * m);
+
+#endif
@@ -0,0 +1,150 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB flash scheduler.
+ * Toggles the flash state every FLASH_PERIOD and optionally keeps the phase 
+ * aligned with other modules on the bus.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "ticktime.h"
+#include "canargb_flash.h"
+#include "canargb_leds.h"
+#include "canargb_nvs.h"
+#include "canargb_service.h"
+#include "canargb_dispatch.h"
+
+static TickValue flashTime;
+static uint8_t syncSequence;
+static uint8_t synced;          // the phase has been aligned at least once
+
+static void updateSkew(uint32_t skew);
+
+/**
+ * Start the flash timer.
+ */
+void initFlash(void) {
+    flashTime.val = tickGet();
+    syncSequence = 0;
+    synced = FALSE;
+}
+
+/**
+ * Check whether the flash state is due to be toggled.
+ * @return TRUE if the flash is due
+ */
+uint8_t flashDue(void) {
+    return (tickTimeSince(flashTime) > FLASH_PERIOD);
+}
+
+/**
+ * Toggle the flash state when due. A sync master broadcasts its phase each 
+ * time the LEDs enter the flash on state.
+ */
+void pollFlash(void) {
+    if ( ! flashDue()) return;
+    doFlash();
+    flashTime.val = tickGet();
+    if (flashOn() && ((uint8_t)getNV(NV_FLASH_SYNC) == FLASH_SYNC_MASTER)) {
+        sendMessage7(OPC_ACDAT, nn.bytes.hi, nn.bytes.lo, FLASH_SYNC_MARKER, 1, syncSequence++, 0, 0);
+    }
+}
+
+/**
+ * A sync slave uses the master's flash sync message to realign its flash 
+ * timer. Phases are measured over the full on/off cycle from entering the on
+ * state. The master's phase is taken from the time the message was received,
+ * not when it was processed, so time spent queued isn't counted as skew. The
+ * skew is the phase error when the message was received, before it is 
+ * corrected. The first message only aligns the phase.
+ * 
+ * @param m the received message
+ * @return PROCESSED if the message was a flash sync from our master
+ */
+Processed flashSyncPreProcess(Message * m) {
+    uint32_t phase;
+    uint32_t target;
+    uint32_t offset;
+    
+    if ((m->opc != OPC_ACDAT) || (m->len < 8) || (m->bytes[2] != FLASH_SYNC_MARKER)) return NOT_PROCESSED;
+    if ((uint8_t)getNV(NV_FLASH_SYNC) != FLASH_SYNC_SLAVE) return NOT_PROCESSED;
+    if ((m->bytes[0] != (uint8_t)getNV(NV_FLASH_MASTER_HI)) || (m->bytes[1] != (uint8_t)getNV(NV_FLASH_MASTER_LO))) return NOT_PROCESSED;
+    
+    // our phase and the master's phase now
+    phase = tickTimeSince(flashTime);
+    if ( ! flashOn()) {
+        phase += FLASH_PERIOD;
+    }
+    target = tickTimeSince(dispatchArrival());
+    if (m->bytes[3] == 0) {
+        target += FLASH_PERIOD;
+    }
+    phase %= 2*FLASH_PERIOD;
+    target %= 2*FLASH_PERIOD;
+    
+    offset = (phase >= target) ? (phase - target) : (target - phase);
+    if (offset > FLASH_PERIOD) {
+        offset = 2*FLASH_PERIOD - offset;
+    }
+    if (synced) {
+        updateSkew(offset);
+    }
+    synced = TRUE;
+    
+    // take on the master's phase
+    if (target >= FLASH_PERIOD) {
+        target -= FLASH_PERIOD;
+        if (flashOn()) doFlash();
+    } else {
+        if ( ! flashOn()) doFlash();
+    }
+    flashTime.val = tickGet() - target;
+    return PROCESSED;
+}
+
+/**
+ * Record the skew in microseconds in the diagnostics.
+ * @param skew the skew in ticks
+ */
+static void updateSkew(uint32_t skew) {
+    skew *= 16;     // 16us per tick
+    if (skew > 0xFFFF) skew = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_FLASH_SKEW].asUint = (uint16_t)skew;
+    if ((uint16_t)skew > canargbDiagnostics[CANARGB_DIAG_FLASH_SKEW_MAX].asUint) {
+        canargbDiagnostics[CANARGB_DIAG_FLASH_SKEW_MAX].asUint = (uint16_t)skew;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB flash scheduler.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_FLASH_H_
+#define _CANARGB_FLASH_H_
+
+#include "vlcb.h"
+
+/*
+ * The flash phase can be synchronised across several CANARGB modules. With 
+ * NV_FLASH_SYNC set to FLASH_SYNC_MASTER the module broadcasts an ACDAT each 
+ * time its LEDs enter the flash on state. Modules with NV_FLASH_SYNC set to 
+ * FLASH_SYNC_SLAVE measure their phase error against the message and then 
+ * restart their flash timer from it. A slave only uses messages from the node
+ * set in NV_FLASH_MASTER_HI/LO.
+ */
+#define FLASH_PERIOD            HALF_SECOND
+
+#define FLASH_SYNC_OFF          0
+#define FLASH_SYNC_MASTER       1
+#define FLASH_SYNC_SLAVE        2
+
+// ACDAT data byte 1 used to identify a flash sync message
+#define FLASH_SYNC_MARKER       0x46
+
+extern void initFlash(void);
+extern void pollFlash(void);
+extern uint8_t flashDue(void);
+extern Processed flashSyncPreProcess(Message * m);
+
+#endif
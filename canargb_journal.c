@@ -0,0 +1,427 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB LED state journal.
+ * The EEPROM writes are broken into jobs of up to a record which are written
+ * a byte at a time, last byte first, so that the sequence byte at the start
+ * of a record or header is written last.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "nvm.h"
+#include "canargb_journal.h"
+#include "canargb_events.h"
+#include "canargb_layers.h"
+#include "canargb_leds.h"
+#include "canargb_nvs.h"
+#include "canargb_service.h"
+
+#define JOURNAL_IDLE        0   // appending queued records to the active half
+#define JOURNAL_SNAPSHOT    1   // writing the snapshot records to the other half
+#define JOURNAL_SCRUB       2   // invalidating old records in the other half which look current
+#define JOURNAL_HEADER      3   // writing the header of the other half
+
+#define HALF_ADDRESS(h)     (JOURNAL_ADDRESS + (uint16_t)(h)*JOURNAL_HALF_SIZE)
+#define RECORD_ADDRESS(h,r) (HALF_ADDRESS(h) + JOURNAL_HEADER_SIZE + (uint16_t)(r)*JOURNAL_RECORD_SIZE)
+
+// EEPROM is at the top of the NVM address space
+#define EEPROM_NVMADRU      0x38
+#define NVM_CMD_WRITE_BYTE  0x03
+
+typedef struct {
+    uint8_t action;
+    uint8_t start;
+    uint8_t end;
+    uint8_t colour;
+} JournalRecord;
+
+static uint8_t activeHalf;
+static uint8_t sequence;
+static uint8_t recordCount;         // records in the active half
+static uint8_t state;
+static uint8_t compactRequested;
+static uint8_t replaying;
+static uint8_t suspended;
+
+static JournalRecord queue[JOURNAL_QUEUE];
+static uint8_t queueHead;
+static uint8_t queueTail;
+
+static JournalRecord snapshot[JOURNAL_CAPACITY];
+static uint8_t snapshotCount;
+static uint8_t snapshotPos;
+
+static uint8_t jobBytes[JOURNAL_RECORD_SIZE];
+static uint16_t jobAddress;
+static uint8_t jobPos;              // bytes of the job still to be written
+
+static uint32_t bytesWritten;
+static uint32_t instructionsJournalled;
+
+static uint8_t readByte(uint16_t address);
+static void startWrite(uint16_t address, uint8_t value);
+static uint8_t nextJob(void);
+static void loadRecord(uint8_t half, uint8_t slot, uint8_t seq, JournalRecord * r);
+static uint8_t buildSnapshot(void);
+static uint8_t addSnapshot(uint8_t action, uint8_t start, uint8_t end, uint8_t colour);
+static void updateDiagnostics(void);
+
+/**
+ * Find the active half of the journal. If there isn't a valid half then a
+ * compaction is requested to write an empty journal.
+ */
+void initJournal(void) {
+    uint8_t validA, validB;
+    uint8_t seqA, seqB;
+    uint8_t r;
+    
+    validA = (readByte(HALF_ADDRESS(0)) == JOURNAL_MARKER);
+    validB = (readByte(HALF_ADDRESS(1)) == JOURNAL_MARKER);
+    seqA = readByte(HALF_ADDRESS(0)+1);
+    seqB = readByte(HALF_ADDRESS(1)+1);
+    
+    state = JOURNAL_IDLE;
+    queueHead = queueTail = 0;
+    jobPos = 0;
+    replaying = FALSE;
+    suspended = FALSE;
+    compactRequested = FALSE;
+    bytesWritten = 0;
+    instructionsJournalled = 0;
+    
+    if (validA && ( ! validB || ((int8_t)(seqA - seqB) > 0))) {
+        activeHalf = 0;
+        sequence = seqA;
+    } else if (validB) {
+        activeHalf = 1;
+        sequence = seqB;
+    } else {
+        activeHalf = 0;
+        sequence = 0;
+        compactRequested = TRUE;
+    }
+    for (r=0; r<JOURNAL_CAPACITY; r++) {
+        if (compactRequested || (readByte(RECORD_ADDRESS(activeHalf, r)) != sequence)) break;
+    }
+    recordCount = r;
+    updateDiagnostics();
+}
+
+/**
+ * Perform the instructions in the active half of the journal and render the
+ * frame so that the first refresh shows the restored state.
+ */
+void replayJournal(void) {
+    uint8_t r;
+    uint16_t address;
+    
+    if (getNV(NV_PERSIST) == 0) return;
+    replaying = TRUE;
+    for (r=0; r<recordCount; r++) {
+        address = RECORD_ADDRESS(activeHalf, r);
+        performInstruction(readByte(address+1), readByte(address+2), readByte(address+3), readByte(address+4));
+    }
+    replaying = FALSE;
+    renderFrameNow();
+}
+
+/**
+ * Stop, or start again, journalling the instructions performed. Used by the
+ * benchmark so that the timed decodes don't change the persisted LED state.
+ * @param suspend TRUE to stop journalling
+ */
+void journalSuspend(uint8_t suspend) {
+    suspended = suspend;
+}
+
+/**
+ * Add a performed instruction to the journal. An instruction which repeats the
+ * last queued one with a different colour or bank replaces it.
+ * 
+ * @param action the action EV
+ * @param start the start LED or palette bank
+ * @param end the end LED
+ * @param colour the colour pair
+ */
+void journalInstruction(uint8_t action, uint8_t start, uint8_t end, uint8_t colour) {
+    uint8_t next;
+    JournalRecord * r;
+    
+    if (replaying || suspended) return;
+    if (getNV(NV_PERSIST) == 0) return;
+    action &= (ACTION_OPCODE_MASK | ACTION_LAYER_MASK);
+    instructionsJournalled++;
+    
+    if (queueHead != queueTail) {
+        r = &queue[(queueHead-1) & (JOURNAL_QUEUE-1)];
+        if ((r->action == action) && (r->start == start) && (r->end == end)) {
+            r->colour = colour;
+            return;
+        }
+    }
+    next = (queueHead+1) & (JOURNAL_QUEUE-1);
+    if (next == queueTail) {
+        // no room, a snapshot will include the change
+        compactRequested = TRUE;
+        return;
+    }
+    r = &queue[queueHead];
+    r->action = action;
+    r->start = start;
+    r->end = end;
+    r->colour = colour;
+    queueHead = next;
+}
+
+/**
+ * Write a fresh snapshot of the LED state, used when persistence is turned on.
+ */
+void journalRestart(void) {
+    compactRequested = TRUE;
+}
+
+/**
+ * Wait for any EEPROM write started by the journal to finish. Used before 
+ * anything else writes to NVM.
+ */
+void journalWaitIdle(void) {
+    while (NVMCON0bits.GO)
+        ;
+}
+
+/**
+ * Check whether the journal has an EEPROM write in progress.
+ * @return TRUE if NVM is busy
+ */
+uint8_t journalBusy(void) {
+    return NVMCON0bits.GO;
+}
+
+/**
+ * Start the next EEPROM byte write if the previous one has finished.
+ */
+void pollJournal(void) {
+    if (NVMCON0bits.GO) return;
+    for (;;) {
+        while (jobPos > 0) {
+            jobPos--;
+            if (readByte(jobAddress+jobPos) != jobBytes[jobPos]) {
+                startWrite(jobAddress+jobPos, jobBytes[jobPos]);
+                return;
+            }
+        }
+        if ( ! nextJob()) return;
+    }
+}
+
+/**
+ * Set up the next write job.
+ * @return FALSE if there is nothing to write
+ */
+static uint8_t nextJob(void) {
+    uint8_t slot;
+    
+    switch (state) {
+        case JOURNAL_SNAPSHOT:
+            if (snapshotPos < snapshotCount) {
+                loadRecord(1-activeHalf, snapshotPos, sequence+1, &snapshot[snapshotPos]);
+                snapshotPos++;
+                return TRUE;
+            }
+            state = JOURNAL_SCRUB;
+            return TRUE;
+        case JOURNAL_SCRUB:
+            // old records after the snapshot with the new sequence number would be replayed
+            for (slot = snapshotPos; slot < JOURNAL_CAPACITY; slot++) {
+                if (readByte(RECORD_ADDRESS(1-activeHalf, slot)) == (uint8_t)(sequence+1)) {
+                    jobAddress = RECORD_ADDRESS(1-activeHalf, slot);
+                    jobBytes[0] = (uint8_t)~(sequence+1);
+                    jobPos = 1;
+                    snapshotPos = slot+1;
+                    return TRUE;
+                }
+            }
+            jobAddress = HALF_ADDRESS(1-activeHalf);
+            jobBytes[0] = JOURNAL_MARKER;
+            jobBytes[1] = sequence+1;
+            jobPos = JOURNAL_HEADER_SIZE;
+            state = JOURNAL_HEADER;
+            return TRUE;
+        case JOURNAL_HEADER:
+            activeHalf = 1-activeHalf;
+            sequence++;
+            recordCount = snapshotCount;
+            state = JOURNAL_IDLE;
+            canargbDiagnostics[CANARGB_DIAG_JOURNAL_COMPACTIONS].asUint++;
+            updateDiagnostics();
+            return TRUE;
+        default:    // JOURNAL_IDLE
+            if (compactRequested || ((queueHead != queueTail) && (recordCount >= JOURNAL_CAPACITY))) {
+                compactRequested = FALSE;
+                // the snapshot includes anything queued
+                queueTail = queueHead;
+                if ( ! buildSnapshot()) {
+                    canargbDiagnostics[CANARGB_DIAG_JOURNAL_FAILURES].asUint++;
+                    return FALSE;
+                }
+                snapshotPos = 0;
+                state = JOURNAL_SNAPSHOT;
+                return TRUE;
+            }
+            if (queueHead == queueTail) return FALSE;
+            loadRecord(activeHalf, recordCount, sequence, &queue[queueTail]);
+            queueTail = (queueTail+1) & (JOURNAL_QUEUE-1);
+            recordCount++;
+            updateDiagnostics();
+            return TRUE;
+    }
+}
+
+/**
+ * Set up a job to write a record.
+ * @param half the journal half
+ * @param slot the record number within the half
+ * @param seq the sequence number of the half
+ * @param r the record
+ */
+static void loadRecord(uint8_t half, uint8_t slot, uint8_t seq, JournalRecord * r) {
+    jobAddress = RECORD_ADDRESS(half, slot);
+    jobBytes[0] = seq;
+    jobBytes[1] = r->action;
+    jobBytes[2] = r->start;
+    jobBytes[3] = r->end;
+    jobBytes[4] = r->colour;
+    jobPos = JOURNAL_RECORD_SIZE;
+}
+
+/**
+ * Describe the current LED state as the palette bank followed by the runs of 
+ * LEDs of the same colour pair on each layer. Colour pair 0 on the base layer
+ * is the power up state so isn't included.
+ * @return FALSE if the state needs more than JOURNAL_CAPACITY records
+ */
+static uint8_t buildSnapshot(void) {
+    uint8_t layer;
+    uint16_t ledno;
+    uint8_t start;
+    uint8_t colour;
+    uint8_t inRun;
+    
+    snapshotCount = 0;
+    if (paletteBank() != 0) {
+        if ( ! addSnapshot(ACTION_SELECT_BANK, paletteBank(), 0, 0)) return FALSE;
+    }
+    for (layer=0; layer<NUM_LAYERS; layer++) {
+        inRun = FALSE;
+        for (ledno=0; ledno<=MAX_LEDS; ledno++) {
+            if (inRun) {
+                if ((ledno < MAX_LEDS) && layerCovers(layer, (uint8_t)ledno) && (layerColour(layer, (uint8_t)ledno) == colour)) continue;
+                if ((layer != 0) || (colour != 0)) {
+                    if ( ! addSnapshot(ACTION_SET_RANGE | (uint8_t)(layer << ACTION_LAYER_SHIFT), start, (uint8_t)(ledno-1), colour)) return FALSE;
+                }
+                inRun = FALSE;
+            }
+            if ((ledno < MAX_LEDS) && layerCovers(layer, (uint8_t)ledno)) {
+                inRun = TRUE;
+                start = (uint8_t)ledno;
+                colour = layerColour(layer, (uint8_t)ledno);
+            }
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * Add a record to the snapshot.
+ * @return FALSE if the snapshot is full
+ */
+static uint8_t addSnapshot(uint8_t action, uint8_t start, uint8_t end, uint8_t colour) {
+    if (snapshotCount >= JOURNAL_CAPACITY) return FALSE;
+    snapshot[snapshotCount].action = action;
+    snapshot[snapshotCount].start = start;
+    snapshot[snapshotCount].end = end;
+    snapshot[snapshotCount].colour = colour;
+    snapshotCount++;
+    return TRUE;
+}
+
+/**
+ * Read a byte of EEPROM.
+ * @param address the EEPROM address
+ * @return the byte
+ */
+static uint8_t readByte(uint16_t address) {
+    return (uint8_t)readNVM(EEPROM_NVM_TYPE, address);
+}
+
+/**
+ * Start writing a byte of EEPROM without waiting for the write to finish.
+ * @param address the EEPROM address
+ * @param value the byte to write
+ */
+static void startWrite(uint16_t address, uint8_t value) {
+    uint8_t gie;
+    
+    NVMADRU = EEPROM_NVMADRU;
+    NVMADRH = (uint8_t)(address >> 8);
+    NVMADRL = (uint8_t)address;
+    NVMDATL = value;
+    NVMCON1bits.CMD = NVM_CMD_WRITE_BYTE;
+    gie = INTCON0bits.GIE;
+    di();
+    NVMLOCK = 0x55;
+    NVMLOCK = 0xAA;
+    NVMCON0bits.GO = 1;
+    INTCON0bits.GIE = gie;
+    bytesWritten++;
+    updateDiagnostics();
+}
+
+/**
+ * Update the journal size and write amplification diagnostics. The write
+ * amplification is the EEPROM bytes written per byte of instruction journalled.
+ */
+static void updateDiagnostics(void) {
+    uint32_t amp;
+    
+    canargbDiagnostics[CANARGB_DIAG_JOURNAL_RECORDS].asUint = recordCount;
+    canargbDiagnostics[CANARGB_DIAG_JOURNAL_BYTES].asUint = (bytesWritten > 0xFFFF) ? 0xFFFF : (uint16_t)bytesWritten;
+    if (instructionsJournalled) {
+        amp = (bytesWritten * 100) / (instructionsJournalled * sizeof(JournalRecord));
+        canargbDiagnostics[CANARGB_DIAG_JOURNAL_WRITE_AMP].asUint = (amp > 0xFFFF) ? 0xFFFF : (uint16_t)amp;
+    }
+}
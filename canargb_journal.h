@@ -0,0 +1,80 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB LED state journal.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_JOURNAL_H_
+#define _CANARGB_JOURNAL_H_
+
+#include "vlcb.h"
+
+/*
+ * The LED instructions performed are journalled to EEPROM so that the LEDs
+ * can be restored at power up. The journal area is split into two halves which
+ * are used alternately. The active half has a header followed by records of
+ * the instructions performed since it was started. When it is full the 
+ * current state of the layers is written to the other half as a compact set
+ * of range records, which then becomes the active half.
+ * 
+ * Header: JOURNAL_MARKER, sequence number
+ * Record: sequence number, action, start, end, colour
+ * 
+ * The newer half, by sequence number, with a valid marker is the active half.
+ * Records are only valid if they have the sequence number of their half. The
+ * sequence byte of a record, and the marker of a header, are written last so 
+ * that a write interrupted by power loss isn't replayed.
+ * 
+ * EEPROM is written a byte at a time from the poll loop without waiting for
+ * the write to complete and bytes which already hold the required value are
+ * not written.
+ */
+#define JOURNAL_HALF_SIZE       (JOURNAL_SIZE/2)
+#define JOURNAL_HEADER_SIZE     2
+#define JOURNAL_RECORD_SIZE     5
+#define JOURNAL_CAPACITY        ((JOURNAL_HALF_SIZE - JOURNAL_HEADER_SIZE)/JOURNAL_RECORD_SIZE)
+#define JOURNAL_MARKER          0x4A
+#define JOURNAL_QUEUE           8       // must be a power of 2
+
+extern void initJournal(void);
+extern void replayJournal(void);
+extern void pollJournal(void);
+extern void journalInstruction(uint8_t action, uint8_t start, uint8_t end, uint8_t colour);
+extern void journalRestart(void);
+extern void journalWaitIdle(void);
+extern uint8_t journalBusy(void);
+extern void journalSuspend(uint8_t suspend);
+
+#endif
@@ -0,0 +1,158 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB compositing layers.
+ * Changes to a layer recomposite just the range of LEDs changed. The visible
+ * colour pairs are passed to updateLedRange() which ignores LEDs which don't
+ * change.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "canargb_layers.h"
+#include "canargb_leds.h"
+
+#define LAYER_BITMAP_SIZE   ((MAX_LEDS+7)/8)
+
+static PaletteIndex layerIndexes[NUM_LAYERS][MAX_LEDS];
+static uint8_t layerCoverage[NUM_LAYERS][LAYER_BITMAP_SIZE];
+
+static void compositeRange(uint8_t start, uint8_t end);
+
+/**
+ * Set every layer to colour pair 0 with only the base layer covering the LEDs.
+ */
+void initLayers(void) {
+    uint8_t l;
+    uint8_t i;
+    
+    for (l=0; l<NUM_LAYERS; l++) {
+        for (i=0; i<MAX_LEDS; i++) {
+            layerIndexes[l][i].asByte = 0;
+        }
+        for (i=0; i<LAYER_BITMAP_SIZE; i++) {
+            layerCoverage[l][i] = (l == 0) ? 0xFF : 0;
+        }
+    }
+}
+
+/**
+ * Set a range of LEDs on a layer to a colour pair.
+ * @param layer the layer 0..NUM_LAYERS-1
+ * @param start the first LED
+ * @param end the last LED
+ * @param colour the colour pair, flash off colour << 4 | flash on colour
+ */
+void setLayerRange(uint8_t layer, uint8_t start, uint8_t end, uint8_t colour) {
+    uint8_t ledno;
+    
+    if (layer >= NUM_LAYERS) return;
+    if (end >= MAX_LEDS) end = MAX_LEDS-1;
+    if (start > end) return;
+    for (ledno=start; ; ledno++) {
+        layerIndexes[layer][ledno].asByte = colour;
+        layerCoverage[layer][ledno >> 3] |= (uint8_t)(1 << (ledno & 7));
+        if (ledno == end) break;
+    }
+    compositeRange(start, end);
+}
+
+/**
+ * Remove a range of LEDs from a layer so the layers below show through. 
+ * Clearing the base layer sets the LEDs to colour pair 0.
+ * @param layer the layer 0..NUM_LAYERS-1
+ * @param start the first LED
+ * @param end the last LED
+ */
+void clearLayerRange(uint8_t layer, uint8_t start, uint8_t end) {
+    uint8_t ledno;
+    
+    if (layer == 0) {
+        setLayerRange(0, start, end, 0);
+        return;
+    }
+    if (layer >= NUM_LAYERS) return;
+    if (end >= MAX_LEDS) end = MAX_LEDS-1;
+    if (start > end) return;
+    for (ledno=start; ; ledno++) {
+        layerCoverage[layer][ledno >> 3] &= (uint8_t)~(1 << (ledno & 7));
+        if (ledno == end) break;
+    }
+    compositeRange(start, end);
+}
+
+/**
+ * Check whether a layer has set an LED.
+ * @param layer the layer 0..NUM_LAYERS-1
+ * @param ledno the LED
+ * @return TRUE if the layer covers the LED
+ */
+uint8_t layerCovers(uint8_t layer, uint8_t ledno) {
+    return (layerCoverage[layer][ledno >> 3] & (uint8_t)(1 << (ledno & 7))) != 0;
+}
+
+/**
+ * Get the colour pair of an LED on a layer.
+ * @param layer the layer 0..NUM_LAYERS-1
+ * @param ledno the LED
+ * @return the colour pair, only meaningful if the layer covers the LED
+ */
+uint8_t layerColour(uint8_t layer, uint8_t ledno) {
+    return layerIndexes[layer][ledno].asByte;
+}
+
+/**
+ * Work out the visible colour pair of a range of LEDs from the highest layer
+ * covering each LED.
+ * @param start the first LED
+ * @param end the last LED
+ */
+static void compositeRange(uint8_t start, uint8_t end) {
+    uint8_t ledno;
+    uint8_t l;
+    uint8_t byte;
+    uint8_t mask;
+    
+    for (ledno=start; ; ledno++) {
+        byte = ledno >> 3;
+        mask = (uint8_t)(1 << (ledno & 7));
+        for (l=NUM_LAYERS-1; l>0; l--) {
+            if (layerCoverage[l][byte] & mask) break;
+        }
+        updateLedRange(ledno, ledno, layerIndexes[l][ledno]);
+        if (ledno == end) break;
+    }
+}
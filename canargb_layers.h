@@ -0,0 +1,59 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB compositing layers.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_LAYERS_H_
+#define _CANARGB_LAYERS_H_
+
+#include "vlcb.h"
+
+/*
+ * Instructions set LEDs on one of NUM_LAYERS layers. Each layer has a colour
+ * pair per LED and a coverage bitmap of the LEDs it has set. The colour shown
+ * for an LED is taken from the highest layer covering it, so clearing a range
+ * of an overlay layer shows the layers below again. Layer 0 is the base layer
+ * and covers every LED.
+ */
+#define NUM_LAYERS      4
+
+extern void initLayers(void);
+extern void setLayerRange(uint8_t layer, uint8_t start, uint8_t end, uint8_t colour);
+extern void clearLayerRange(uint8_t layer, uint8_t start, uint8_t end);
+extern uint8_t layerCovers(uint8_t layer, uint8_t ledno);
+extern uint8_t layerColour(uint8_t layer, uint8_t ledno);
+
+#endif
@@ -39,37 +39,201 @@
 #include <xc.h>
 #include "module.h"
 #include "nv.h"
+#include "ticktime.h"
 
 #include "canargb_leds.h"
+#include "canargb_service.h"
 
 typedef struct Colours {
     uint8_t r;
     uint8_t g;
     uint8_t b;
 } Colours;
-static Colours leds[MAX_LEDS];
+
+typedef struct ColoursW {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t w;
+} ColoursW;
+
+/*
+ * The pixel buffers hold either 3 byte RGB or 4 byte RGBW pixels depending
+ * upon the pixel format.
+ */
+typedef union PixelBuffer {
+    Colours rgb[MAX_LEDS];
+    ColoursW rgbw[MAX_LEDS];
+} PixelBuffer;
+static PixelBuffer leds;        // the frame being rendered
+static PixelBuffer frame;       // the complete frame sent to the string
 
 
 PaletteIndex ledPaletteIndexes[MAX_LEDS];
 
+static Colours palette[NUM_COLOURS];    // the active palette in string byte order
+static ColoursW paletteW[NUM_COLOURS];  // the active palette for RGBW pixels
+static uint8_t pixelFormat;
+static uint8_t bytesPerLed;
+static uint16_t frameBytes;
+static uint8_t pixelFormatChanged;
+static uint8_t activeBank;
+static uint16_t changedColours;         // bit per palette entry changed but not yet repainted
+
+/*
+ * Reverse index from palette entry to the LEDs using it. There is a bit per
+ * LED in each entry's bitmap which is set if either nibble of the LED's 
+ * PaletteIndex uses that entry.
+ */
+#define LED_BITMAP_SIZE     ((MAX_LEDS+7)/8)
+static uint8_t paletteUsers[NUM_COLOURS][LED_BITMAP_SIZE];
+
+/*
+ * Current limiter. The number of LEDs showing each palette entry in each flash
+ * state is kept up to date by updateLedRange() so the frame current can be
+ * estimated from the palette without looking at the pixels. If the estimate
+ * is over budget the resolved palette is scaled.
+ */
+static uint8_t flashOnCount[NUM_COLOURS];
+static uint8_t flashOffCount[NUM_COLOURS];
+static uint16_t paletteLevel[NUM_COLOURS];  // r+g+b of each unscaled palette entry
+static uint16_t currentScale;               // palette scale factor in 1/256 units
+static uint8_t currentChanged;              // the estimate needs to be recalculated
+
+/*
+ * Temporal dithering. The resolved palette is also kept with 8 fractional bits
+ * per channel, in string byte order, and each LED channel accumulates the 
+ * fractional part frame by frame. Whenever the accumulator overflows the LED
+ * channel is shown one step brighter for that frame. Whilst any palette entry
+ * has a fractional part frames are rendered continuously.
+ */
+static uint16_t paletteFine[NUM_COLOURS][4];
+static uint8_t ditherError[MAX_LEDS*4];
+static uint8_t ditherMode;
+static uint8_t ditherActive;                // the resolved palette has fractional bits
+static uint32_t renderTicks;                // CPU time spent on the frame being rendered
+
 static uint8_t flashState;
 static uint8_t refreshRequired;
 
+/*
+ * Chunked rendering. A full render is done RENDER_CHUNK LEDs at a time from
+ * pollRender() and only copied to the frame buffer once the whole frame has
+ * been rendered and the string is not being refreshed.
+ */
+#define RENDER_IDLE         0
+#define RENDER_FULL         1
+#define RENDER_COMMIT       2
+
+#define RENDER_REQ_NONE     0
+#define RENDER_REQ_UPDATE   1   // LED indexes changed, the render in progress can continue
+#define RENDER_REQ_RESTART  2   // flash state or palette changed, the render in progress must restart
+
+static uint8_t renderState;
+static uint8_t renderRequest;
+static uint16_t renderPos;
+static uint16_t repaintMask;            // palette entries waiting to be repainted
+static uint8_t frameDirty;              // leds[] has changes not yet copied to frame[]
+static uint8_t selfTestRequested;
+static uint8_t outputReady;             // the SPI/CLC/DSM/DMA chain has been set up
+
+/*
+ * The render functions are specialised for the pixel format and selected
+ * once by selectPixelFormat().
+ */
+static void (*renderRange)(uint16_t start, uint16_t end);
+static void (*paintLed)(uint8_t ledno, uint8_t c);
+static void renderRangeRGB(uint16_t start, uint16_t end);
+static void renderRangeRGBW(uint16_t start, uint16_t end);
+static void paintLedRGB(uint8_t ledno, uint8_t c);
+static void paintLedRGBW(uint8_t ledno, uint8_t c);
+static void renderRangeDither(uint16_t start, uint16_t end);
+static void paintLedDither(uint8_t ledno, uint8_t c);
+static void ditherLed(uint16_t ledno, uint8_t c);
+static void selectPixelFormat(void);
+static void repaintColours(uint16_t colours);
+static uint8_t outputIdle(void);
+static uint8_t updateCurrentLimit(void);
+static void initOutput(void);
+#ifdef DMA
+static void selfTest(void);
+static void sendFrame(void);
+#else
+/*
+ * Without DMA the frame is fed to SPI1 a byte at a time from the SPI1TX 
+ * interrupt so the main loop keeps running whilst the frame is sent.
+ */
+static volatile uint8_t * txNext;
+static volatile uint16_t txRemaining;
+static void startOutput(uint16_t bytes);
+#endif
+
 //#define FAST_MODE
 
 void initARGB(void) {
     uint8_t ledno;
+    uint8_t c;
+    uint8_t i;
+    uint16_t n;
+    uint8_t * p;
     
+    selectPixelFormat();
+    pixelFormatChanged = 0;
     flashState = 0;
+    activeBank = 0;
+    changedColours = 0;
+    repaintMask = 0;
+    renderState = RENDER_IDLE;
+    renderRequest = RENDER_REQ_NONE;
+    frameDirty = 0;
+    selfTestRequested = 0;
+    currentScale = CURRENT_SCALE_FULL;
+    resolvePalette();
     
+    for (c=0; c<NUM_COLOURS; c++) {
+        for (i=0; i<LED_BITMAP_SIZE; i++) {
+            paletteUsers[c][i] = 0;
+        }
+        flashOnCount[c] = 0;
+        flashOffCount[c] = 0;
+    }
+    flashOnCount[0] = MAX_LEDS;
+    flashOffCount[0] = MAX_LEDS;
+    // black (off)
+    p = (uint8_t *)&leds;
+    for (n=0; n<sizeof(PixelBuffer); n++) {
+        *p++ = 0;
+    }
+    p = (uint8_t *)&frame;
+    for (n=0; n<sizeof(PixelBuffer); n++) {
+        *p++ = 0;
+    }
     for (ledno=0; ledno <MAX_LEDS; ledno++) {
-        leds[ledno].r = 0;    // black (off)
-        leds[ledno].g = 0;    // black (off)
-        leds[ledno].b = 0;    // black (off)
+        paletteUsers[0][ledno>>3] |= (uint8_t)(1 << (ledno & 7));
         ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex = 0;   // probably black
         ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex = 0;  // probably black
     }
     
+    initOutput();
+#ifdef DMA
+    // wait for the early dark frame to finish before resizing the transfer
+    DMASELECT = 0;
+    while (DMAnCON0bits.SIRQEN)
+        ;
+    DMAnSSZ = frameBytes;
+#endif
+    
+    refreshRequired = 1;
+}
+
+/**
+ * Set up the peripherals which generate the string signal. Only done once as
+ * the early dark frame may have already done it.
+ */
+static void initOutput(void) {
+    if (outputReady) return;
+    outputReady = TRUE;
+    
     /* Now set up the peripherals to drive the WS2811 signal.
      * We'll use SPI as a host/master, a PWM as a pulse generator and CLC to
      * combine the 2 signals. 
@@ -234,7 +398,7 @@ void initARGB(void) {
         MD1SRC = 0x1F;      // SPI1_SDO
     }
 
-    // Set up DMA1 to transfer 3 x 256 bytes to SPI1TXB
+    // Set up DMA1 to transfer 3 or 4 x 255 bytes to SPI1TXB
     // DMA transaction = 1 byte. DMA message = 0x300 bytes.
 #ifdef DMA
     {
@@ -243,8 +407,8 @@ void initARGB(void) {
         DMAnCON1bits.SMR=0;         // 0 => SFR/GPR data space is DMA source memory
         DMAnCON1bits.SMODE=1;       // 1 => Source pointer increments
         DMAnCON1bits.SSTP=1;        // 1 => Clear SIRQEN once all data transferred
-        DMAnSSZ=3*MAX_LEDS;         // 3 x number of LED for the total number of colour bytes
-        DMAnSSA=(__uint24)leds;     // the array of byes for the LEDs
+        DMAnSSZ=sizeof(PixelBuffer);    // resized by initARGB() for the pixel format
+        DMAnSSA=(__uint24)&frame;   // the array of byes for the LEDs
         DMAnDSZ=1;                  // 1 byte of SPI1TXR
         DMAnDSA=(uint16_t)&SPI1TXB; // SPI1 transmit buffer
         DMAnSIRQ=0x19;              // 0x19 => SPI1TX
@@ -262,147 +426,763 @@ void initARGB(void) {
     T2CONbits.ON = 1;
     T4CONbits.ON = 1;
     MD1CON0bits.EN = 1;
+}
+
+/**
+ * Send an all black frame as soon as possible after power up so that the 
+ * LEDs don't show random colours whilst the rest of the module initialises.
+ * The frame buffer has been cleared by the C runtime startup and is sent for
+ * the largest pixel format so it is long enough for any string.
+ * The time since the VLCB tick was started is recorded in the diagnostics.
+ */
+void earlyDarkFrame(void) {
+#ifndef DMA
+    uint16_t offset;
+#endif
     
-    refreshRequired = 1;
+    initOutput();
+    canargbDiagnostics[CANARGB_DIAG_FIRST_FRAME_TIME].asUint = (uint16_t)(tickGet() * 16);
+#ifdef DMA
+    SPI1TCNT = sizeof(PixelBuffer);
+    DMAnCON0bits.SIRQEN = 1;
+#else
+    // interrupts aren't enabled yet so this frame is sent by polling
+    for (offset=0; offset < sizeof(PixelBuffer); ) {
+        if (PIR3bits.SPI1TXIF) {
+            SPI1TXB = 0;
+            offset++;
+        }
+    }
+#endif
 }
 
 /** Update a range of LEDs in the leds array based upon the request range and colour index pair.
  * The pair is made up of an upper nibble and a lower nibble. Flashing alternates between these two
  * indexes. The index is the offset into the palette.
+ * The reverse index of palette entry to LEDs is kept up to date.
  */ 
 void updateLedRange(uint8_t start_ledno, uint8_t end_ledno, PaletteIndex colourIndexPair) {
     uint8_t ledno;
+    uint8_t mask;
+    uint8_t byte;
+    PaletteIndex old;
+    
     if (end_ledno >= MAX_LEDS) end_ledno = MAX_LEDS-1;
     if (start_ledno >= MAX_LEDS) start_ledno = MAX_LEDS-1;
     if (start_ledno > end_ledno) end_ledno = start_ledno;
     // update the LED array using the 2 nibbles of the new colour. a value of 0 is no change
     for(ledno=start_ledno; ledno<=end_ledno; ledno++) {
+        old = ledPaletteIndexes[ledno];
+        if (old.asByte == colourIndexPair.asByte) continue;
+        byte = ledno >> 3;
+        mask = (uint8_t)(1 << (ledno & 7));
+        paletteUsers[old.asNibbles.flashOnPaletteIndex][byte] &= ~mask;
+        paletteUsers[old.asNibbles.flashOffPaletteIndex][byte] &= ~mask;
+        paletteUsers[colourIndexPair.asNibbles.flashOnPaletteIndex][byte] |= mask;
+        paletteUsers[colourIndexPair.asNibbles.flashOffPaletteIndex][byte] |= mask;
+        flashOnCount[old.asNibbles.flashOnPaletteIndex]--;
+        flashOffCount[old.asNibbles.flashOffPaletteIndex]--;
+        flashOnCount[colourIndexPair.asNibbles.flashOnPaletteIndex]++;
+        flashOffCount[colourIndexPair.asNibbles.flashOffPaletteIndex]++;
         ledPaletteIndexes[ledno] = colourIndexPair;
+        currentChanged = 1;
     }
 }
 
 /**
- * Schedule a refresh of the LEDs.
+ * Schedule a render and refresh of the LEDs.
  */
 void updateRGB(void) {
+    if (renderRequest == RENDER_REQ_NONE) {
+        renderRequest = RENDER_REQ_UPDATE;
+    }
+}
+
+/**
+ * Check whether there is rendering to be done or the string is waiting to be
+ * refreshed.
+ * @return TRUE if a render or refresh is required
+ */
+uint8_t refreshPending(void) {
+    if (refreshRequired) return TRUE;
+    if (renderState != RENDER_IDLE) return TRUE;
+    if (renderRequest != RENDER_REQ_NONE) return TRUE;
+    if (repaintMask) return TRUE;
+    return (frameDirty && outputIdle());
+}
+
+/**
+ * Check whether all the requested rendering has been done and the frame is in
+ * the frame buffer. Continuous rendering whilst dithering is ignored.
+ * @return TRUE if there is no rendering outstanding
+ */
+uint8_t renderComplete(void) {
+    if (renderState != RENDER_IDLE) return FALSE;
+    if (repaintMask || frameDirty || pixelFormatChanged || currentChanged) return FALSE;
+    if ((renderRequest != RENDER_REQ_NONE) && ! ditherActive) return FALSE;
+    return TRUE;
+}
+
+/**
+ * Do the rendering work for up to RENDER_BUDGET. At least one chunk is done
+ * on each call. A complete frame is copied to the frame buffer, in chunks,
+ * whilst the string is idle and then a refresh is scheduled.
+ */
+void pollRender(void) {
+    TickValue start;
+    uint16_t end;
+    uint8_t * src;
+    uint8_t * dst;
+    uint16_t n;
+    TickValue chunkStart;
+    
+    start.val = tickGet();
+    do {
+        switch (renderState) {
+            case RENDER_IDLE:
+                if (pixelFormatChanged && outputIdle()) {
+                    pixelFormatChanged = 0;
+                    frameDirty = 0;     // rendered in the old format
+                    selectPixelFormat();
+#ifdef DMA
+                    DMASELECT = 0;
+                    DMAnSSZ = frameBytes;
+#endif
+                    resolvePalette();
+                    renderRequest = RENDER_REQ_RESTART;
+                }
+                if (currentChanged) {
+                    currentChanged = 0;
+                    if (updateCurrentLimit()) {
+                        repaintMask = 0xFFFF;
+                    }
+                }
+#ifdef DMA
+                if (selfTestRequested && outputIdle()) {
+                    selfTestRequested = 0;
+                    selfTest();
+                    frameDirty = 1;     // put back the real frame
+                    return;
+                }
+#endif
+                if (repaintMask == 0xFFFF) {
+                    resolvePalette();
+                    repaintMask = 0;
+                    renderRequest = RENDER_REQ_RESTART;
+                }
+                if (repaintMask) {
+                    resolvePalette();
+                    repaintColours(repaintMask);
+                    repaintMask = 0;
+                }
+                if (frameDirty && outputIdle()) {
+                    frameDirty = 0;
+                    renderPos = 0;
+                    renderState = RENDER_COMMIT;
+                } else if (renderRequest != RENDER_REQ_NONE) {
+                    renderRequest = RENDER_REQ_NONE;
+                    renderPos = 0;
+                    renderTicks = 0;
+                    renderState = RENDER_FULL;
+                } else {
+                    return;
+                }
+                break;
+            case RENDER_FULL:
+                if ((renderRequest == RENDER_REQ_RESTART) || (repaintMask == 0xFFFF)) {
+                    renderState = RENDER_IDLE;
+                    break;
+                }
+                end = renderPos + RENDER_CHUNK;
+                if (end > MAX_LEDS) end = MAX_LEDS;
+                chunkStart.val = tickGet();
+                renderRange(renderPos, end);
+                renderTicks += tickTimeSince(chunkStart);
+                renderPos = end;
+                if (renderPos >= MAX_LEDS) {
+                    if (renderTicks > statsRenderTime) statsRenderTime = renderTicks;
+                    frameDirty = 1;
+                    renderState = RENDER_IDLE;
+                }
+                break;
+            case RENDER_COMMIT:
+                end = renderPos + RENDER_CHUNK;
+                if (end > MAX_LEDS) end = MAX_LEDS;
+                src = (uint8_t *)&leds + renderPos*bytesPerLed;
+                dst = (uint8_t *)&frame + renderPos*bytesPerLed;
+                for (n = (end - renderPos)*bytesPerLed; n > 0; n--) {
+                    *dst++ = *src++;
+                }
+                renderPos = end;
+                if (renderPos >= MAX_LEDS) {
+                    refreshRequired = 1;
+                    renderState = RENDER_IDLE;
+                    if (ditherActive) {
+                        // start on the next dithered frame whilst this one is sent
+                        updateRGB();
+                    }
+                }
+                break;
+        }
+    } while (tickTimeSince(start) < RENDER_BUDGET);
+}
+
+/**
+ * Render the whole frame straight into the frame buffer and schedule a 
+ * refresh. Only used during initialisation, whilst the string is idle, so the
+ * first refresh shows the restored LED state.
+ */
+void renderFrameNow(void) {
+    uint8_t * src;
+    uint8_t * dst;
+    uint16_t n;
+    
+    resolvePalette();
+    renderRange(0, MAX_LEDS);
+    src = (uint8_t *)&leds;
+    dst = (uint8_t *)&frame;
+    for (n = frameBytes; n > 0; n--) {
+        *dst++ = *src++;
+    }
+    frameDirty = 0;
+    renderRequest = RENDER_REQ_NONE;
     refreshRequired = 1;
 }
 
 /**
- * Toggle between flashStates of flashOn and flashOff. Update the led colours
- * based by looking up from the palette. 
+ * Request a self test of the string output timing. The test is run from 
+ * pollRender() once the string is idle.
+ */
+void requestSelfTest(void) {
+    selfTestRequested = 1;
+}
+
+#ifdef DMA
+/**
+ * Measure the string output waveform by looping RC0 back into SMT1 using PPS.
+ * A frame with a single 1 bit in each byte, the dimmest frame which isn't 
+ * black, is sent with SMT1 in period and duty cycle acquisition mode. The 
+ * shortest and longest high times are T0H and T1H and the shortest period is
+ * the bit period. The frame is then sent again with SMT1 as a timer to 
+ * measure the frame time.
+ * The CPU polls SMT1 during the frames so the VLCB poll is held off for two
+ * frame times.
+ */
+static void selfTest(void) {
+    uint24_t width;
+    uint24_t minWidth;
+    uint24_t maxWidth;
+    uint24_t period;
+    uint24_t minPeriod;
+    uint16_t i;
+    uint8_t * p;
+    
+    p = (uint8_t *)&frame;
+    for (i=0; i<frameBytes; i++) {
+        *p++ = 0x01;
+    }
+    minWidth = 0xFFFFFF;
+    maxWidth = 0;
+    minPeriod = 0xFFFFFF;
+    
+    SMT1SIGPPS = 0x10;      // RC0 (DSM1 output) loopback
+    SMT1CLK = 0x01;         // Fosc, 15.625ns resolution
+    SMT1SIG = 0x00;         // SMT1SIGPPS
+    SMT1PR = 0xFFFFFF;
+    SMT1CON0 = 0x80;        // enabled, 1:1 prescalar
+    SMT1CON1 = 0x42;        // repeat, period and duty cycle acquisition
+    PIR1bits.SMT1PWAIF = 0;
+    PIR1bits.SMT1PRAIF = 0;
+    SMT1CON1bits.GO = 1;
+    sendFrame();
+    while (DMAnCON0bits.SIRQEN) {
+        if (PIR1bits.SMT1PWAIF) {
+            PIR1bits.SMT1PWAIF = 0;
+            width = SMT1CPW;
+            if (width < minWidth) minWidth = width;
+            if (width > maxWidth) maxWidth = width;
+        }
+        if (PIR1bits.SMT1PRAIF) {
+            PIR1bits.SMT1PRAIF = 0;
+            period = SMT1CPR;
+            if (period < minPeriod) minPeriod = period;
+        }
+    }
+    SMT1CON1bits.GO = 0;
+    
+    // now time the whole frame
+    while (SPI1CON2bits.BUSY)
+        ;
+    SMT1CON1 = 0x00;        // single, timer mode
+    SMT1TMR = 0;
+    SMT1CON1bits.GO = 1;
+    sendFrame();
+    while (DMAnCON0bits.SIRQEN)
+        ;
+    while (SPI1CON2bits.BUSY)
+        ;
+    period = SMT1TMR;
+    SMT1CON1bits.GO = 0;
+    SMT1CON0 = 0;
+    
+    if (maxWidth == 0) {
+        // no loopback signal
+        minWidth = 0;
+        minPeriod = 0;
+    }
+    canargbDiagnostics[CANARGB_DIAG_OUTPUT_T0H].asUint = (uint16_t)(((uint32_t)minWidth * 125) / 8);
+    canargbDiagnostics[CANARGB_DIAG_OUTPUT_T1H].asUint = (uint16_t)(((uint32_t)maxWidth * 125) / 8);
+    canargbDiagnostics[CANARGB_DIAG_OUTPUT_BIT_PERIOD].asUint = (uint16_t)(((uint32_t)minPeriod * 125) / 8);
+    canargbDiagnostics[CANARGB_DIAG_OUTPUT_FRAME_TIME].asUint = (uint16_t)(period / 64);
+}
+
+/**
+ * Start a DMA transfer of frame[] to the string.
+ */
+static void sendFrame(void) {
+    SPI1TCNT = frameBytes;
+    DMAnCON0bits.SIRQEN = 1;
+}
+#endif
+
+/**
+ * Check whether the frame buffer can be written.
+ * @return TRUE if the string is not being refreshed
+ */
+static uint8_t outputIdle(void) {
+    if (refreshRequired) return FALSE;
+    return ! outputBusy();
+}
+
+/**
+ * Check whether a frame is being sent to the string.
+ * @return TRUE if the frame buffer is being read by the output
+ */
+uint8_t outputBusy(void) {
+#ifdef DMA
+    if (DMAnCON0bits.SIRQEN || DMAnCON0bits.DGO) return TRUE;
+#else
+    // txRemaining can't be read atomically, the ISR clears the enable at the end
+    if (PIE3bits.SPI1TXIE) return TRUE;
+#endif
+    return FALSE;
+}
+
+#ifndef DMA
+/**
+ * Start sending the frame buffer to the string from the SPI1TX interrupt.
+ * @param bytes the number of bytes to send
+ */
+static void startOutput(uint16_t bytes) {
+    txNext = (uint8_t *)&frame;
+    txRemaining = bytes;
+    IPR3bits.SPI1TXIP = 1;      // high priority so the string doesn't see a gap
+    PIE3bits.SPI1TXIE = 1;
+}
+
+/**
+ * Load the next byte of the frame each time there is room in the SPI1
+ * transmit FIFO. The interrupt is disabled after the last byte.
+ */
+void __interrupt(irq(SPI1TX), base(IVT_BASE)) spiTxIsr(void) {
+    SPI1TXB = *txNext++;
+    if (--txRemaining == 0) {
+        PIE3bits.SPI1TXIE = 0;
+    }
+}
+#endif
+
+/**
+ * Estimate the current of the flash on and flash off frames from the palette
+ * and the number of LEDs using each palette entry and work out the scale 
+ * factor needed to keep the larger within the NV_CURRENT_LIMIT budget.
+ * 
+ * @return TRUE if the scale factor has changed
+ */
+static uint8_t updateCurrentLimit(void) {
+    uint32_t onLevel;
+    uint32_t offLevel;
+    uint32_t budget;
+    uint32_t mA;
+    uint16_t scale;
+    uint8_t c;
+    
+    onLevel = 0;
+    offLevel = 0;
+    for (c=0; c<NUM_COLOURS; c++) {
+        onLevel += (uint32_t)flashOnCount[c] * paletteLevel[c];
+        offLevel += (uint32_t)flashOffCount[c] * paletteLevel[c];
+    }
+    if (offLevel > onLevel) onLevel = offLevel;
+    
+    mA = (onLevel * LED_CHANNEL_MA) / 255;
+    canargbDiagnostics[CANARGB_DIAG_CURRENT_ESTIMATE].asUint = (mA > 0xFFFF) ? 0xFFFF : (uint16_t)mA;
+    
+    scale = CURRENT_SCALE_FULL;
+    budget = (uint32_t)getNV(NV_CURRENT_LIMIT) * 100;   // mA
+    if (budget && (mA > budget)) {
+        scale = (uint16_t)((budget * CURRENT_SCALE_FULL) / mA);
+    }
+    canargbDiagnostics[CANARGB_DIAG_CURRENT_SCALE].asUint = scale;
+    if (scale == currentScale) return FALSE;
+    currentScale = scale;
+    return TRUE;
+}
+
+/**
+ * Map a palette NV value to a channel level with 8 fractional bits. With
+ * DITHER_GAMMA the NV value is on a gamma 2 curve so the low values give the
+ * fine steps needed for dim colours.
+ * @param v the palette NV value
+ * @return the channel level in 8.8 format
+ */
+static uint16_t channelLevel(uint8_t v) {
+    if (ditherMode == DITHER_GAMMA) {
+        return (uint16_t)v * v;
+    }
+    return (uint16_t)v << 8;
+}
+
+/**
+ * Build the resolved palette from the NVs of the active palette bank. The 
+ * resolved palette holds the colours in the byte order required by the string
+ * so rendering is just a copy of the palette entry. The current limiter scale
+ * is applied here.
+ */
+void resolvePalette(void) {
+    uint8_t c;
+    uint8_t posR, posG, posB;
+    uint16_t r,g,b,w;
+    uint8_t * p;
+    
+    // byte offset within a pixel of each channel
+    switch ((uint8_t)getNV(NV_COLOUR_ORDER)) {
+        case ORDER_RGB:
+            posR = 0; posG = 1; posB = 2;
+            break;
+        case ORDER_RBG:
+            posR = 0; posG = 2; posB = 1;
+            break;
+        case ORDER_GBR:
+            posR = 2; posG = 0; posB = 1;
+            break;
+        case ORDER_BRG:
+            posR = 1; posG = 2; posB = 0;
+            break;
+        case ORDER_BGR:
+            posR = 2; posG = 1; posB = 0;
+            break;
+        default: // case ORDER_GRB:
+            posR = 1; posG = 0; posB = 2;
+            break;
+    }
+    ditherActive = FALSE;
+    for (c=0; c<NUM_COLOURS; c++) {
+        r = channelLevel(RED(activeBank, c));
+        g = channelLevel(GREEN(activeBank, c));
+        b = channelLevel(BLUE(activeBank, c));
+        w = 0;
+        if (pixelFormat == PIXEL_FORMAT_RGBW) {
+            // the common part of r, g and b is shown using the white LED
+            w = r;
+            if (g < w) w = g;
+            if (b < w) w = b;
+            r -= w;
+            g -= w;
+            b -= w;
+        }
+        paletteLevel[c] = (r >> 8) + (g >> 8) + (b >> 8) + (w >> 8);
+        if (currentScale < CURRENT_SCALE_FULL) {
+            r = (uint16_t)(((uint32_t)r * currentScale) >> 8);
+            g = (uint16_t)(((uint32_t)g * currentScale) >> 8);
+            b = (uint16_t)(((uint32_t)b * currentScale) >> 8);
+            w = (uint16_t)(((uint32_t)w * currentScale) >> 8);
+        }
+        paletteFine[c][posR] = r;
+        paletteFine[c][posG] = g;
+        paletteFine[c][posB] = b;
+        paletteFine[c][3] = w;
+        // with DITHER_LINEAR only the current limiter produces fractional bits,
+        // without it nothing needs dithering and frames aren't re-rendered
+        if (((uint8_t)r | (uint8_t)g | (uint8_t)b | (uint8_t)w) && (ditherMode != DITHER_OFF)) {
+            ditherActive = TRUE;
+        }
+        
+        p = (uint8_t *)&palette[c];
+        p[posR] = (uint8_t)(r >> 8);
+        p[posG] = (uint8_t)(g >> 8);
+        p[posB] = (uint8_t)(b >> 8);
+        paletteW[c].r = palette[c].r;
+        paletteW[c].g = palette[c].g;
+        paletteW[c].b = palette[c].b;
+        paletteW[c].w = (uint8_t)(w >> 8);
+    }
+    currentChanged = 1;
+}
+
+/**
+ * Select the render functions and buffer sizes for the pixel format given by
+ * NV_PIXEL_FORMAT.
+ */
+static void selectPixelFormat(void) {
+    uint16_t n;
+    
+    pixelFormat = (uint8_t)getNV(NV_PIXEL_FORMAT);
+    if (pixelFormat == PIXEL_FORMAT_RGBW) {
+        bytesPerLed = 4;
+        renderRange = renderRangeRGBW;
+        paintLed = paintLedRGBW;
+    } else {
+        pixelFormat = PIXEL_FORMAT_RGB;
+        bytesPerLed = 3;
+        renderRange = renderRangeRGB;
+        paintLed = paintLedRGB;
+    }
+    frameBytes = (uint16_t)bytesPerLed * MAX_LEDS;
+    
+    ditherMode = (uint8_t)getNV(NV_DITHER);
+    if (ditherMode != DITHER_OFF) {
+        renderRange = renderRangeDither;
+        paintLed = paintLedDither;
+        for (n=0; n<sizeof(ditherError); n++) {
+            ditherError[n] = 0;
+        }
+    }
+}
+
+/**
+ * Switch to a different palette bank. The palette is resolved once and all
+ * the LEDs are repainted in a single frame.
+ * @param bank the palette bank 0..NUM_PALETTE_BANKS-1
+ */
+void selectPaletteBank(uint8_t bank) {
+    if (bank >= NUM_PALETTE_BANKS) return;
+    activeBank = bank;
+    repaintMask = 0xFFFF;
+}
+
+/**
+ * Get the active palette bank.
+ * @return the palette bank 0..NUM_PALETTE_BANKS-1
+ */
+uint8_t paletteBank(void) {
+    return activeBank;
+}
+
+/**
+ * Called when an NV has been changed. If it affects the active palette then
+ * the colour is marked as changed. Several NVs can be changed before calling
+ * applyPaletteChanges() to show them.
+ * @param index the NV index
+ */
+void paletteNvChanged(uint8_t index) {
+    uint8_t base;
+    
+    base = NV_PALETTE_BANK(activeBank);
+    if ((index == NV_PIXEL_FORMAT) || (index == NV_DITHER)) {
+        pixelFormatChanged = 1;
+    } else if (index == NV_CURRENT_LIMIT) {
+        currentChanged = 1;
+    } else if (index == NV_COLOUR_ORDER) {
+        changedColours = 0xFFFF;
+    } else if ((index >= base) && (index < base+PALETTE_BANK_SIZE)) {
+        changedColours |= (uint16_t)1 << ((index-base)/3);
+    }
+}
+
+/**
+ * Schedule the palette to be resolved again and just the LEDs which are 
+ * currently showing one of the changed colours to be repainted.
+ */
+void applyPaletteChanges(void) {
+    repaintMask |= changedColours;
+    changedColours = 0;
+}
+
+/**
+ * Toggle between flashStates of flashOn and flashOff. Schedule the led colours
+ * to be rendered by looking up from the palette. 
  */
 void doFlash(void) {
+    flashState = 1-flashState;
+    renderRequest = RENDER_REQ_RESTART;
+}
+
+/**
+ * Get the current flash state.
+ * @return TRUE if the LEDs are showing their flash on colours
+ */
+uint8_t flashOn(void) {
+    return flashState;
+}
+
+/**
+ * Set the colour of a range of RGB LEDs from the resolved palette according to the 
+ * current flashState.
+ * @param start the first LED
+ * @param end one past the last LED
+ */
+static void renderRangeRGB(uint16_t start, uint16_t end) {
+    uint16_t ledno;
+    
+    if (flashState) {
+        for (ledno=start; ledno < end; ledno++) {
+            leds.rgb[ledno] = palette[ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex];
+        }
+    } else {
+        for (ledno=start; ledno < end; ledno++) {
+            leds.rgb[ledno] = palette[ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex];
+        }
+    }
+}
+
+/**
+ * Set the colour of a range of RGBW LEDs from the resolved palette according to the 
+ * current flashState.
+ * @param start the first LED
+ * @param end one past the last LED
+ */
+static void renderRangeRGBW(uint16_t start, uint16_t end) {
+    uint16_t ledno;
+    
+    if (flashState) {
+        for (ledno=start; ledno < end; ledno++) {
+            leds.rgbw[ledno] = paletteW[ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex];
+        }
+    } else {
+        for (ledno=start; ledno < end; ledno++) {
+            leds.rgbw[ledno] = paletteW[ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex];
+        }
+    }
+}
+
+/**
+ * Set a single RGB LED to a palette entry.
+ * @param ledno the LED
+ * @param c the palette entry
+ */
+static void paintLedRGB(uint8_t ledno, uint8_t c) {
+    leds.rgb[ledno] = palette[c];
+}
+
+/**
+ * Set a single RGBW LED to a palette entry.
+ * @param ledno the LED
+ * @param c the palette entry
+ */
+static void paintLedRGBW(uint8_t ledno, uint8_t c) {
+    leds.rgbw[ledno] = paletteW[c];
+}
+
+/**
+ * Set the colour of a range of LEDs from the fine resolved palette according
+ * to the current flashState, spreading the fractional part of each channel 
+ * over successive frames.
+ * @param start the first LED
+ * @param end one past the last LED
+ */
+static void renderRangeDither(uint16_t start, uint16_t end) {
+    uint16_t ledno;
+    
+    if (flashState) {
+        for (ledno=start; ledno < end; ledno++) {
+            ditherLed(ledno, ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
+        }
+    } else {
+        for (ledno=start; ledno < end; ledno++) {
+            ditherLed(ledno, ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
+        }
+    }
+}
+
+/**
+ * Set a single dithered LED to a palette entry.
+ * @param ledno the LED
+ * @param c the palette entry
+ */
+static void paintLedDither(uint8_t ledno, uint8_t c) {
+    ditherLed(ledno, c);
+}
+
+/**
+ * Add the fractional part of each channel of a palette entry to the LED's
+ * error accumulators and output the integer part, plus one for each 
+ * accumulator which overflowed. A channel with an integer part of 255 has
+ * no fractional part so the output cannot overflow.
+ * @param ledno the LED
+ * @param c the palette entry
+ */
+static void ditherLed(uint16_t ledno, uint8_t c) {
+    uint8_t i;
+    uint8_t * dst;
+    uint8_t * err;
+    uint16_t * fine;
+    uint16_t sum;
+    
+    dst = (uint8_t *)&leds + ledno*bytesPerLed;
+    err = ditherError + ledno*bytesPerLed;
+    fine = paletteFine[c];
+    for (i=0; i<bytesPerLed; i++) {
+        sum = (uint16_t)*err + (uint8_t)*fine;
+        *err++ = (uint8_t)sum;
+        *dst++ = (uint8_t)(*fine >> 8) + (uint8_t)(sum >> 8);
+        fine++;
+    }
+}
+
+/**
+ * Set the colour of the LEDs which are showing one of the specified palette
+ * entries according to the current flashState. Uses the reverse index so only
+ * the LEDs which use the changed entries are visited.
+ * @param colours bit per palette entry to be repainted
+ */
+static void repaintColours(uint16_t colours) {
     uint8_t ledno;
-    uint8_t order;
+    uint8_t c;
+    uint8_t i;
+    uint8_t bits;
+    PaletteIndex pi;
     
-    flashState = 1-flashState;
-    order = (uint8_t)getNV(NV_COLOUR_ORDER);
-    
-    for (ledno=0; ledno < MAX_LEDS; ledno++) {
-        if (flashState) {
-            switch (order) {
-                case ORDER_RGB:
-                    leds[ledno].r = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].g = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].b = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-                case ORDER_RBG:
-                    leds[ledno].r = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].b = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].g = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-                case ORDER_GBR:
-                    leds[ledno].b = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].r = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].g = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-                case ORDER_BRG:
-                    leds[ledno].g = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].b = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].r = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-                case ORDER_BGR:
-                    leds[ledno].b = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].g = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].r = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-                default: // case ORDER_GRB:
-                    leds[ledno].g = RED(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].r = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    leds[ledno].b = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOnPaletteIndex);
-                    break;
-            }
-            
-        } else {
-            switch (order) {
-                case ORDER_RGB:
-                    leds[ledno].r = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].g = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].b = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
-                case ORDER_RBG:
-                    leds[ledno].r = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].b = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].g = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
-                case ORDER_GBR:
-                    leds[ledno].b = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].r = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].g = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
-                case ORDER_BRG:
-                    leds[ledno].g = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].b = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].r = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
-                case ORDER_BGR:
-                    leds[ledno].b = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].g = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].r = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
-                default: // case ORDER_GRB:
-                    leds[ledno].g = RED(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].r = GREEN(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    leds[ledno].b = BLUE(ledPaletteIndexes[ledno].asNibbles.flashOffPaletteIndex);
-                    break;
+    for (c=0; c<NUM_COLOURS; c++, colours >>= 1) {
+        if ((colours & 1) == 0) continue;
+        for (i=0; i<LED_BITMAP_SIZE; i++) {
+            bits = paletteUsers[c][i];
+            for (ledno = (uint8_t)(i << 3); bits; ledno++, bits >>= 1) {
+                if ((bits & 1) == 0) continue;
+                pi = ledPaletteIndexes[ledno];
+                if ((flashState ? pi.asNibbles.flashOnPaletteIndex : pi.asNibbles.flashOffPaletteIndex) == c) {
+                    paintLed(ledno, c);
+                }
             }
-            
         }
     }
-    refreshRequired = 1;
+    frameDirty = 1;
 }
 
 /**
  * Refresh the string of LEDs by outputting the LED data according to WS2811 spec.
  * This sends the data for each LED in turn, starting with the one nearest the module.
- * Each LED had 24 bits, made up of 8 red, 8 green, 8 blue bits. Each colour byte 
+ * Each LED had 24 bits, made up of 8 red, 8 green, 8 blue bits, or 32 bits for RGBW
+ * pixels with an additional 8 white bits. Each colour byte 
  * is sent MSB first with a 1 as a 0.8us logic 1 followed by a 0.45us logic 0. 
  * A 0 bit is a 0.45us logic 1 followed by a 0.8us logic 0. The end of the entire
  * 256 LED frame is indicated by at least 50us at logic 0.  
  */
 void refreshString(void) {
-    uint16_t offset;
-    
     // if a transfer is already in progress then wait
     //if (DMAnCON0bits.DGO) return;
 //    sendByte();
     if (refreshRequired) {
         refreshRequired = 0;
+        statsFrameCount++;
 #ifdef DMA
         // Start a transfer
-        SPI1TCNT = 3 * MAX_LEDS;
+        SPI1TCNT = frameBytes;
         DMAnCON0bits.SIRQEN = 1;
-#else       
-        // do a transfer
-        offset = 0;
-        while (offset < 3*MAX_LEDS) {
-            if (PIR3bits.SPI1TXIF) {
-                SPI1TXB = *(offset+(uint8_t *)leds);
-                offset++;
-            }
-        }
-#endif 
+#else
+        // Start an interrupt driven transfer
+        startOutput(frameBytes);
+#endif
 
 LATCbits.LATC6 = flashState;
     }
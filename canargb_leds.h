@@ -55,9 +55,38 @@ typedef union PaletteIndex {
     uint8_t asByte;
 } PaletteIndex;
 
+/*
+ * Rendering is done in chunks of RENDER_CHUNK LEDs for up to RENDER_BUDGET
+ * ticks (about 200us) per call to pollRender() so that the VLCB poll is not
+ * held off whilst a whole frame is rendered.
+ */
+#define RENDER_CHUNK    32
+#define RENDER_BUDGET   (HUNDRED_MILI_SECOND/500)
+
+/*
+ * Current limiter. Each WS2811 channel draws about LED_CHANNEL_MA at full
+ * brightness. CURRENT_SCALE_FULL is a palette scale factor of 1.
+ */
+#define LED_CHANNEL_MA      20
+#define CURRENT_SCALE_FULL  256
+
 extern void updateLedRange(uint8_t start_ledno, uint8_t end_ledno, PaletteIndex colour);
 extern void refreshString(void);
+extern void pollRender(void);
+extern void requestSelfTest(void);
 extern void initARGB(void);
+extern void earlyDarkFrame(void);
 extern void doFlash(void);
+extern uint8_t flashOn(void);
 extern void updateRGB(void);
+extern uint8_t refreshPending(void);
+extern uint8_t renderComplete(void);
+extern uint8_t outputBusy(void);
+extern void resolvePalette(void);
+extern void selectPaletteBank(uint8_t bank);
+extern uint8_t paletteBank(void);
+extern void renderFrameNow(void);
+extern void paletteNvChanged(uint8_t index);
+extern void applyPaletteChanges(void);
+// read only, use updateLedRange() to change so that the reverse index is maintained
 extern PaletteIndex ledPaletteIndexes[MAX_LEDS];
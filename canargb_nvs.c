@@ -40,11 +40,15 @@
 #include <xc.h>
 #include "module.h"
 #include "canargb_nvs.h"
+#include "canargb_leds.h"
+#include "canargb_flash.h"
+#include "canargb_journal.h"
 #include "nv.h"
+#include "ticktime.h"
 
 typedef struct {uint8_t red,green,blue;} Colour;
 
-static const Colour defaultColours [16] = {
+static const Colour defaultColours [NUM_COLOURS] = {
     {0x00,0x00,0x00},    // 0 black
     {0x07,0x07,0x07},    // 1 dark grey
     {0x07,0x00,0x00},    // 2 dark red
@@ -64,15 +68,29 @@ static const Colour defaultColours [16] = {
 };
 
         
+/*
+ * The staged palette NV writes.
+ */
+static uint8_t stagedIndex[NV_STAGE_SIZE];
+static uint8_t stagedValue[NV_STAGE_SIZE];
+static uint8_t numStaged;
+static TickValue stagedTime;
+
 /**
  * The Application specific NV defaults are defined here. 1 .. NUM_NV
+ * All the palette banks default to the same colours.
  */
 uint8_t APP_nvDefault(uint8_t index) {
     if (index == NV_COLOUR_ORDER) {
         return ORDER_GRB;
     }
-    index--;
-    if (index < NV_NUM) {
+    if (index >= NV_PALETTE_BANK_1) {
+        index -= NV_PALETTE_BANK_1;
+    } else {
+        index -= NV_COLOUR_0_R;
+    }
+    if (index < (NUM_PALETTE_BANKS-1)*PALETTE_BANK_SIZE) {
+        index %= PALETTE_BANK_SIZE;
         switch (index%3) {
             case 0:
                 return defaultColours[index/3].red;
@@ -87,15 +105,97 @@ uint8_t APP_nvDefault(uint8_t index) {
 
 /**
  * We validate NV values here.
- * All values are valid.
+ * All palette values are valid.
  */
 NvValidation APP_nvValidate(uint8_t index, uint8_t value)  {
+    if ((index == NV_FLASH_SYNC) && (value > FLASH_SYNC_SLAVE)) return INVALID;
+    if ((index == NV_PIXEL_FORMAT) && (value > PIXEL_FORMAT_RGBW)) return INVALID;
+    if ((index == NV_DITHER) && (value > DITHER_GAMMA)) return INVALID;
     return VALID;
 }
 
 /**
  * We perform the necessary action when an NV changes value.
- * No need to do anything.
+ * If the NV is part of the active palette then the palette needs to be resolved again.
+ * Setting the self test NV runs the output timing self test.
+ * Turning on persistence writes a snapshot of the current LED state.
  */
 void APP_nvValueChanged(uint8_t index, uint8_t value, uint8_t oldValue) {
+    if ((index == NV_SELF_TEST) && value) {
+        requestSelfTest();
+    }
+    if ((index == NV_PERSIST) && value && ! oldValue) {
+        journalRestart();
+    }
+    paletteNvChanged(index);
+    applyPaletteChanges();
+}
+
+/**
+ * Stage NVSETs for the palette NVs. Any other message for this node causes
+ * the staged NVs to be committed first so that the NV service sees consistent
+ * values.
+ * 
+ * @param m the received message
+ * @return PROCESSED if the message was an NVSET that has been staged
+ */
+Processed paletteNvPreProcess(Message * m) {
+    uint8_t index;
+    uint8_t i;
+    
+    if (m->len < 3) return NOT_PROCESSED;
+    if ((m->bytes[0] != nn.bytes.hi) || (m->bytes[1] != nn.bytes.lo)) return NOT_PROCESSED;
+    
+    index = m->bytes[2];
+    if ((m->opc == OPC_NVSET) && (m->len >= 5) && (index >= NV_COLOUR_0_R) && (index <= NV_PALETTE_LAST)) {
+        if (APP_nvValidate(index, m->bytes[3]) == INVALID) {
+            // let the NV service report the error
+            commitNvTransaction();
+            return NOT_PROCESSED;
+        }
+        for (i=0; i<numStaged; i++) {
+            if (stagedIndex[i] == index) break;
+        }
+        if (i >= NV_STAGE_SIZE) {
+            commitNvTransaction();
+            i = 0;
+        }
+        if (i >= numStaged) {
+            stagedIndex[i] = index;
+            numStaged = i+1;
+        }
+        stagedValue[i] = m->bytes[3];
+        stagedTime.val = tickGet();
+        sendMessage2(OPC_WRACK, nn.bytes.hi, nn.bytes.lo);
+        sendMessage5(OPC_GRSP, nn.bytes.hi, nn.bytes.lo, OPC_NVSET, SERVICE_ID_NV, GRSP_OK);
+        return PROCESSED;
+    }
+    commitNvTransaction();
+    return NOT_PROCESSED;
+}
+
+/**
+ * Write all the staged NVs to EEPROM in one burst and then repaint the LEDs
+ * using the changed colours.
+ */
+void commitNvTransaction(void) {
+    uint8_t i;
+    
+    if (numStaged == 0) return;
+    journalWaitIdle();
+    for (i=0; i<numStaged; i++) {
+        saveNV(stagedIndex[i], stagedValue[i]);
+        paletteNvChanged(stagedIndex[i]);
+    }
+    numStaged = 0;
+    applyPaletteChanges();
+}
+
+/**
+ * Commit the staged NVs once the NVSETs have stopped arriving.
+ */
+void pollNvTransaction(void) {
+    if (numStaged && (tickTimeSince(stagedTime) > NV_COMMIT_TIMEOUT)) {
+        commitNvTransaction();
+    }
 }
\ No newline at end of file
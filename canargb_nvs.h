@@ -90,10 +90,31 @@
 #define NV_COLOUR_15_G          47
 #define NV_COLOUR_15_B          48
 #define NV_COLOUR_ORDER         49
+// Additional palette banks, each the same layout as NV1..48
+#define NV_PALETTE_BANK_1       50
+#define NV_PALETTE_BANK_2       98
+#define NV_PALETTE_BANK_3       146
+#define NV_FLASH_SYNC           194     // FLASH_SYNC_OFF, FLASH_SYNC_MASTER or FLASH_SYNC_SLAVE
+#define NV_SELF_TEST            195     // non zero runs the output timing self test at power up and when set
+#define NV_CURRENT_LIMIT        196     // LED supply current budget in 100mA units, 0 for no limit
+#define NV_PIXEL_FORMAT         197     // PIXEL_FORMAT_RGB or PIXEL_FORMAT_RGBW
+#define NV_DITHER               198     // DITHER_OFF, DITHER_LINEAR or DITHER_GAMMA
+#define NV_PERSIST              199     // non zero journals the LED state and restores it at power up
+#define NV_GLOBAL_BASE_HI       200     // global LED number of this node's LED 0, high byte
+#define NV_GLOBAL_BASE_LO       201     // global LED number of this node's LED 0, low byte
+#define NV_FLASH_MASTER_HI      202     // node number of the flash sync master, high byte
+#define NV_FLASH_MASTER_LO      203     // node number of the flash sync master, low byte
 
-#define RED(c)          ((uint8_t)getNV((c)*3 + 1))
-#define GREEN(c)        ((uint8_t)getNV((c)*3 + 2))
-#define BLUE(c)         ((uint8_t)getNV((c)*3 + 3))
+#define NUM_COLOURS             16
+#define NUM_PALETTE_BANKS       4
+#define PALETTE_BANK_SIZE       (NUM_COLOURS*3)
+#define NV_PALETTE_BANK(b)      (((b) == 0) ? NV_COLOUR_0_R : NV_PALETTE_BANK_1 + ((b)-1)*PALETTE_BANK_SIZE)
+
+#define NV_PALETTE_LAST         (NV_PALETTE_BANK_3 + PALETTE_BANK_SIZE - 1)
+
+#define RED(b,c)        ((uint8_t)getNV(NV_PALETTE_BANK(b) + (c)*3))
+#define GREEN(b,c)      ((uint8_t)getNV(NV_PALETTE_BANK(b) + (c)*3 + 1))
+#define BLUE(b,c)       ((uint8_t)getNV(NV_PALETTE_BANK(b) + (c)*3 + 2))
 
 #define ORDER_RGB   1
 #define ORDER_RBG   2
@@ -102,3 +123,22 @@
 #define ORDER_BGR   5
 #define ORDER_BRG   6
 
+#define PIXEL_FORMAT_RGB    0   // WS2811 3 bytes per LED
+#define PIXEL_FORMAT_RGBW   1   // SK6812 4 bytes per LED, white last
+
+#define DITHER_OFF          0   // palette channels are rounded down to 8 bits
+#define DITHER_LINEAR       1   // fractional bits from the current limiter are spread over successive frames
+#define DITHER_GAMMA        2   // as DITHER_LINEAR with the palette NVs on a gamma 2 curve
+
+/*
+ * Palette NV transactions.
+ * NVSETs to the palette NVs are staged in RAM and committed together, either 
+ * NV_COMMIT_TIMEOUT after the last palette NVSET or before any other message 
+ * to this node is processed. The changed colours are then repainted once.
+ */
+#define NV_COMMIT_TIMEOUT       (HUNDRED_MILI_SECOND)
+#define NV_STAGE_SIZE           PALETTE_BANK_SIZE
+
+extern Processed paletteNvPreProcess(Message * m);
+extern void commitNvTransaction(void);
+extern void pollNvTransaction(void);
@@ -0,0 +1,209 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB fast configuration readback.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include <stddef.h>
+#include "module.h"
+#include "vlcb.h"
+#include "can.h"
+#include "event_teach.h"
+#include "canargb_readback.h"
+#include "canargb_events.h"
+
+// The CAN service diagnostic giving the number of transmit buffers in use
+#define READBACK_CAN_TX_BUFFER_USAGE    0x04
+
+#define READBACK_NONE   0
+#define READBACK_NERD   1   // ENRSP for each event
+#define READBACK_EVANS  2   // EVANS for each EV of an event
+#define READBACK_NEVAL  3   // NEVAL for each EV of an event
+
+// mode_flags bits as used by the event teach service
+#define READBACK_FLAG_LEARN     0x01
+#define READBACK_FLAG_NO_EV0    0x08
+
+extern uint8_t mode_flags;
+
+static uint8_t readbackType;
+static uint8_t readbackTableIndex;
+static uint8_t readbackStep;
+static uint8_t readbackCount;
+static Word readbackNN;
+static Word readbackEN;
+static uint8_t readbackEvs[PARAM_NUM_EV_EVENT];
+
+static uint8_t loadEvs(uint8_t tableIndex);
+static uint8_t txBuffersInUse(void);
+static uint8_t sendNext(void);
+
+/**
+ * Start a fast readback if the message is one of the readback requests. 
+ * Anything which the library would reject is left for the library so that 
+ * the error responses are unchanged.
+ * 
+ * @param m the received message
+ * @return PROCESSED if a readback has been started
+ */
+Processed readbackPreProcess(Message * m) {
+    uint8_t tableIndex;
+    
+    switch (m->opc) {
+        case OPC_NERD:
+            if (m->len < 3) return NOT_PROCESSED;
+            if ((m->bytes[0] != nn.bytes.hi) || (m->bytes[1] != nn.bytes.lo)) return NOT_PROCESSED;
+            readbackType = READBACK_NERD;
+            readbackStep = 0;
+            return PROCESSED;
+        case OPC_REQEV:
+            if (m->len < 6) return NOT_PROCESSED;
+            if (! (mode_flags & READBACK_FLAG_LEARN)) return NOT_PROCESSED;
+            if (mode_flags & READBACK_FLAG_NO_EV0) return NOT_PROCESSED;
+            if (m->bytes[4] != 0) return NOT_PROCESSED;
+            readbackNN.bytes.hi = m->bytes[0];
+            readbackNN.bytes.lo = m->bytes[1];
+            readbackEN.bytes.hi = m->bytes[2];
+            readbackEN.bytes.lo = m->bytes[3];
+            tableIndex = findEvent(readbackNN.word, readbackEN.word);
+            if (tableIndex == 0xff) return NOT_PROCESSED;
+            readbackCount = loadEvs(tableIndex);
+            sendMessage6(OPC_EVANS, readbackNN.bytes.hi, readbackNN.bytes.lo, readbackEN.bytes.hi, readbackEN.bytes.lo, 0, readbackCount);
+            readbackType = READBACK_EVANS;
+            readbackStep = 0;
+            return PROCESSED;
+        case OPC_REVAL:
+            if (m->len < 5) return NOT_PROCESSED;
+            if ((m->bytes[0] != nn.bytes.hi) || (m->bytes[1] != nn.bytes.lo)) return NOT_PROCESSED;
+            if (mode_flags & READBACK_FLAG_NO_EV0) return NOT_PROCESSED;
+            if (m->bytes[3] != 0) return NOT_PROCESSED;
+            tableIndex = m->bytes[2] - 1;   // event index to table index
+            if ((tableIndex >= NUM_EVENTS) || (getEN(tableIndex) == 0)) return NOT_PROCESSED;
+            readbackCount = loadEvs(tableIndex);
+            sendMessage5(OPC_NEVAL, nn.bytes.hi, nn.bytes.lo, m->bytes[2], 0, readbackCount);
+            readbackTableIndex = m->bytes[2];
+            readbackType = READBACK_NEVAL;
+            readbackStep = 0;
+            return PROCESSED;
+        default:
+            break;
+    }
+    return NOT_PROCESSED;
+}
+
+/**
+ * Send the next readback responses whilst there is room in the CAN transmit
+ * FIFO.
+ */
+void pollReadback(void) {
+    uint8_t i;
+    
+    for (i=0; (i<READBACK_BURST) && (readbackType != READBACK_NONE); i++) {
+        if (txBuffersInUse() >= READBACK_TX_LIMIT) return;
+        if ( ! sendNext()) {
+            readbackType = READBACK_NONE;
+        }
+    }
+}
+
+/**
+ * Send the next readback response.
+ * @return FALSE when the readback has finished
+ */
+static uint8_t sendNext(void) {
+    Word eventNumber;
+    Word nodeNumber;
+    
+    switch (readbackType) {
+        case READBACK_NERD:
+            // skip over the unused entries
+            while (readbackStep < NUM_EVENTS) {
+                eventNumber.word = getEN(readbackStep);
+                if (eventNumber.word != 0) {
+                    nodeNumber.word = getNN(readbackStep);
+                    sendMessage7(OPC_ENRSP, nn.bytes.hi, nn.bytes.lo, nodeNumber.bytes.hi, nodeNumber.bytes.lo, 
+                            eventNumber.bytes.hi, eventNumber.bytes.lo, readbackStep+1);
+                    readbackStep++;
+                    return TRUE;
+                }
+                readbackStep++;
+            }
+            return FALSE;
+        case READBACK_EVANS:
+            if (readbackStep >= readbackCount) return FALSE;
+            sendMessage6(OPC_EVANS, readbackNN.bytes.hi, readbackNN.bytes.lo, readbackEN.bytes.hi, readbackEN.bytes.lo, 
+                    readbackStep+1, readbackEvs[readbackStep]);
+            readbackStep++;
+            return TRUE;
+        case READBACK_NEVAL:
+            if (readbackStep >= readbackCount) return FALSE;
+            sendMessage5(OPC_NEVAL, nn.bytes.hi, nn.bytes.lo, readbackTableIndex, readbackStep+1, readbackEvs[readbackStep]);
+            readbackStep++;
+            return TRUE;
+        default:
+            break;
+    }
+    return FALSE;
+}
+
+/**
+ * Read the EVs of an event and work out how many need to be sent. Trailing 
+ * instructions with NO_ACTION are not sent.
+ * 
+ * @param tableIndex the event
+ * @return the number of EVs to send
+ */
+static uint8_t loadEvs(uint8_t tableIndex) {
+    uint8_t count;
+    
+    if (readEventEVs(tableIndex, readbackEvs)) return 0;
+    for (count = PARAM_NUM_EV_EVENT; count > 0; count -= 4) {
+        if (readbackEvs[count-4] != NO_ACTION) break;
+    }
+    return count;
+}
+
+/**
+ * Get the number of CAN transmit buffers in use from the CAN service.
+ * @return the number of buffers in use
+ */
+static uint8_t txBuffersInUse(void) {
+    DiagnosticVal * d;
+    
+    d = canService.getDiagnostic(READBACK_CAN_TX_BUFFER_USAGE);
+    if (d == NULL) return 0;
+    return (uint8_t)d->asUint;
+}
@@ -0,0 +1,58 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB fast configuration readback.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_READBACK_H_
+#define _CANARGB_READBACK_H_
+
+#include "vlcb.h"
+
+/*
+ * NERD and the read all EVs forms of REQEV and REVAL are answered by the 
+ * module rather than by the library's timed responses. Instead of sending one
+ * response every timedResponseDelay the responses are sent as fast as the
+ * CAN transmit FIFO empties: up to READBACK_BURST messages per poll whilst
+ * fewer than READBACK_TX_LIMIT transmit buffers are in use.
+ * Only the EVs up to the last used instruction of an event are sent.
+ */
+#define READBACK_TX_LIMIT       16
+#define READBACK_BURST          4
+
+extern Processed readbackPreProcess(Message * m);
+extern void pollReadback(void);
+
+#endif
@@ -0,0 +1,200 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB module specific service.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include <stddef.h>
+#include "module.h"
+#include "vlcb.h"
+#include "can.h"
+#include "ticktime.h"
+#include "canargb_service.h"
+#include "canargb_events.h"
+#include "canargb_nvs.h"
+#include "canargb_timers.h"
+#include "canargb_readback.h"
+#include "canargb_dispatch.h"
+#include "canargb_journal.h"
+#include "canargb_filter.h"
+#include "canargb_leds.h"
+
+// The CAN service diagnostic used for the load statistics
+#define CANARGB_CAN_RX_BUFFER_OVERRUN   0x08
+
+static void canargbPowerUp(void);
+static void canargbPoll(void);
+static DiagnosticVal * canargbGetDiagnostic(uint8_t index);
+static void pollStatistics(void);
+
+DiagnosticVal canargbDiagnostics[NUM_CANARGB_DIAGNOSTICS+1];
+
+uint16_t statsEventCount;
+uint16_t statsFrameCount;
+uint32_t statsLoopTime;
+uint32_t statsDecodeTime;
+uint32_t statsEventQueueTime;
+uint32_t statsConfigQueueTime;
+uint32_t statsRenderTime;
+uint16_t statsFilterRejects;
+uint16_t statsFilterPasses;
+static uint16_t statsOverruns;
+static TickValue statsTime;
+
+/**
+ * The service descriptor for the CANARGB module specific service.
+ */
+const Service canargbService = {
+    SERVICE_ID_CANARGB,     // id
+    1,                      // version
+    NULL,                   // factoryReset
+    canargbPowerUp,         // powerUp
+    NULL,                   // processMessage
+    canargbPoll,            // poll
+    NULL,                   // ESD data
+    canargbGetDiagnostic    // getDiagnostic
+};
+
+/**
+ * Initialise the module diagnostics and get the string dark. This service is
+ * first in services[] so this is the first application code run after the 
+ * library's startup delay.
+ */
+static void canargbPowerUp(void) {
+    uint8_t i;
+    
+    for (i=1; i<=NUM_CANARGB_DIAGNOSTICS; i++) {
+        canargbDiagnostics[i].asUint = 0;
+    }
+    canargbDiagnostics[0].asUint = NUM_CANARGB_DIAGNOSTICS;
+    earlyDarkFrame();
+    statsEventCount = 0;
+    statsFrameCount = 0;
+    statsLoopTime = 0;
+    statsDecodeTime = 0;
+    statsEventQueueTime = 0;
+    statsConfigQueueTime = 0;
+    statsRenderTime = 0;
+    statsFilterRejects = 0;
+    statsFilterPasses = 0;
+    statsOverruns = 0;
+    statsTime.val = tickGet();
+    initTimers();
+    initDispatch();
+    initEventFilter();
+}
+
+/**
+ * Called every time around the VLCB poll loop to perform any module
+ * background processing.
+ */
+static void canargbPoll(void) {
+    pollEventTeach();
+    pollNvTransaction();
+    pollTimers();
+    pollReadback();
+    pollJournal();
+    pollEventFilter();
+    pollStatistics();
+}
+
+/**
+ * Once a second, convert the load counters into rates.
+ */
+static void pollStatistics(void) {
+    DiagnosticVal * d;
+    
+    if (tickTimeSince(statsTime) < ONE_SECOND) return;
+    statsTime.val = tickGet();
+    
+    canargbDiagnostics[CANARGB_DIAG_EVENT_RATE].asUint = statsEventCount;
+    if (statsEventCount > canargbDiagnostics[CANARGB_DIAG_EVENT_RATE_PEAK].asUint) {
+        canargbDiagnostics[CANARGB_DIAG_EVENT_RATE_PEAK].asUint = statsEventCount;
+    }
+    canargbDiagnostics[CANARGB_DIAG_FRAME_RATE].asUint = statsFrameCount;
+    canargbDiagnostics[CANARGB_DIAG_FILTER_REJECTS].asUint = statsFilterRejects;
+    canargbDiagnostics[CANARGB_DIAG_FILTER_PASSES].asUint = statsFilterPasses;
+    statsEventCount = 0;
+    statsFrameCount = 0;
+    statsFilterRejects = 0;
+    statsFilterPasses = 0;
+    
+    statsLoopTime *= 16;     // 16us per tick
+    if (statsLoopTime > 0xFFFF) statsLoopTime = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_LOOP_LATENCY].asUint = (uint16_t)statsLoopTime;
+    if ((uint16_t)statsLoopTime > canargbDiagnostics[CANARGB_DIAG_LOOP_LATENCY_MAX].asUint) {
+        canargbDiagnostics[CANARGB_DIAG_LOOP_LATENCY_MAX].asUint = (uint16_t)statsLoopTime;
+    }
+    statsLoopTime = 0;
+    
+    statsDecodeTime *= 16;
+    if (statsDecodeTime > 0xFFFF) statsDecodeTime = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_EVENT_DECODE_TIME].asUint = (uint16_t)statsDecodeTime;
+    statsDecodeTime = 0;
+    
+    statsEventQueueTime *= 16;
+    if (statsEventQueueTime > 0xFFFF) statsEventQueueTime = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_EVENT_QUEUE_TIME].asUint = (uint16_t)statsEventQueueTime;
+    statsEventQueueTime = 0;
+    
+    statsConfigQueueTime *= 16;
+    if (statsConfigQueueTime > 0xFFFF) statsConfigQueueTime = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_CONFIG_QUEUE_TIME].asUint = (uint16_t)statsConfigQueueTime;
+    statsConfigQueueTime = 0;
+    
+    statsRenderTime *= 16;
+    if (statsRenderTime > 0xFFFF) statsRenderTime = 0xFFFF;
+    canargbDiagnostics[CANARGB_DIAG_RENDER_TIME].asUint = (uint16_t)statsRenderTime;
+    statsRenderTime = 0;
+    
+    d = canService.getDiagnostic(CANARGB_CAN_RX_BUFFER_OVERRUN);
+    if (d != NULL) {
+        canargbDiagnostics[CANARGB_DIAG_RX_OVERRUNS].asUint = d->asUint - statsOverruns;
+        statsOverruns = d->asUint;
+    }
+}
+
+/**
+ * Provide the means to return the diagnostic data.
+ * @param index the diagnostic index
+ * @return a pointer to the diagnostic data or NULL if the data isn't available
+ */
+static DiagnosticVal * canargbGetDiagnostic(uint8_t index) {
+    if (index > NUM_CANARGB_DIAGNOSTICS) {
+        return NULL;
+    }
+    return &(canargbDiagnostics[index]);
+}
@@ -0,0 +1,111 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB module specific service.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_SERVICE_H_
+#define _CANARGB_SERVICE_H_
+
+#include "vlcb.h"
+
+/*
+ * The module specific service is used to provide a poll hook for the 
+ * background tasks of the CANARGB application and to report module specific
+ * diagnostics via RDGN.
+ * The service number is not one of the standard VLCB services.
+ */
+#define SERVICE_ID_CANARGB      0x80
+
+#define NUM_CANARGB_DIAGNOSTICS         40
+#define CANARGB_DIAG_TEACH_EVS          0x01    // number of EVs committed by the last bulk teach
+#define CANARGB_DIAG_TEACH_RATE         0x02    // EVs per second received during the last bulk teach
+#define CANARGB_DIAG_TEACH_ERRORS       0x03    // number of bulk teaches rejected by validation
+#define CANARGB_DIAG_IDLE_FRACTION      0x04    // time spent in IDLE over the last second in 0.1% units
+#define CANARGB_DIAG_IDLE_WAKEUPS       0x05    // number of wakeups from IDLE in the last second
+#define CANARGB_DIAG_EVENT_RATE         0x06    // consumed events processed in the last second
+#define CANARGB_DIAG_EVENT_RATE_PEAK    0x07    // highest consumed event rate since power up
+#define CANARGB_DIAG_FRAME_RATE         0x08    // frames sent to the string in the last second
+#define CANARGB_DIAG_RX_HIGH_WATER      0x09    // most received messages waiting in the dispatch queues
+#define CANARGB_DIAG_RX_OVERRUNS        0x0A    // CAN receive overruns in the last second
+#define CANARGB_DIAG_FLASH_SKEW         0x0B    // flash phase error in us when the last sync message was received, before correction
+#define CANARGB_DIAG_FLASH_SKEW_MAX     0x0C    // largest flash phase error in us since power up
+#define CANARGB_DIAG_LOOP_LATENCY       0x0D    // longest time around the main loop, excluding IDLE, in the last second in us
+#define CANARGB_DIAG_LOOP_LATENCY_MAX   0x0E    // longest time around the main loop, excluding IDLE, since power up in us
+#define CANARGB_DIAG_EVENT_DECODE_TIME  0x0F    // longest time to process a consumed event in the last second in us
+#define CANARGB_DIAG_OUTPUT_T0H         0x10    // self test measured 0 bit high time in ns
+#define CANARGB_DIAG_OUTPUT_T1H         0x11    // self test measured 1 bit high time in ns
+#define CANARGB_DIAG_OUTPUT_BIT_PERIOD  0x12    // self test measured bit period in ns
+#define CANARGB_DIAG_OUTPUT_FRAME_TIME  0x13    // self test measured frame time in us
+#define CANARGB_DIAG_CURRENT_ESTIMATE   0x14    // estimated LED current in mA before limiting
+#define CANARGB_DIAG_CURRENT_SCALE      0x15    // current limiter brightness scale in 1/256 units
+#define CANARGB_DIAG_TIMERS_IN_USE      0x16    // delayed instructions pending
+#define CANARGB_DIAG_TIMERS_HIGH_WATER  0x17    // most delayed instructions pending at once since power up
+#define CANARGB_DIAG_TIMER_OVERFLOWS    0x18    // delayed instructions done immediately because the timer wheel was full
+#define CANARGB_DIAG_FIRST_FRAME_TIME   0x19    // time from the VLCB tick starting to the first (dark) frame in us
+#define CANARGB_DIAG_EVENT_QUEUE_TIME   0x1A    // longest time an event waited in the dispatch queue in the last second in us
+#define CANARGB_DIAG_CONFIG_QUEUE_TIME  0x1B    // longest time a configuration message waited in the dispatch queue in the last second in us
+#define CANARGB_DIAG_RENDER_TIME        0x1C    // longest CPU time spent rendering one frame in the last second in us
+#define CANARGB_DIAG_JOURNAL_RECORDS    0x1D    // records in the active half of the LED state journal
+#define CANARGB_DIAG_JOURNAL_BYTES      0x1E    // journal EEPROM bytes written since power up
+#define CANARGB_DIAG_JOURNAL_WRITE_AMP  0x1F    // journal EEPROM bytes written per byte of instruction journalled in 0.01 units
+#define CANARGB_DIAG_JOURNAL_COMPACTIONS 0x20   // journal compactions since power up
+#define CANARGB_DIAG_JOURNAL_FAILURES   0x21    // compactions abandoned because the LED state needed too many records
+#define CANARGB_DIAG_FILTER_REJECTS     0x22    // events dropped by the foreign event filter in the last second
+#define CANARGB_DIAG_FILTER_PASSES      0x23    // events passed by the foreign event filter in the last second
+#define CANARGB_DIAG_BENCH_FRAME_RATE   0x24    // benchmark frames per second with a full repaint of every frame
+#define CANARGB_DIAG_BENCH_REPAINT_TIME 0x25    // benchmark full repaint render time in us
+#define CANARGB_DIAG_BENCH_RANGE_TIME   0x26    // benchmark single range update and render time in us
+#define CANARGB_DIAG_BENCH_FLASH_TIME   0x27    // benchmark flash toggle render time in us
+#define CANARGB_DIAG_BENCH_DECODE_TIME  0x28    // benchmark event decode time in us
+
+extern const Service canargbService;
+extern DiagnosticVal canargbDiagnostics[NUM_CANARGB_DIAGNOSTICS+1];
+
+/*
+ * Load statistics counters, incremented by the module and converted to rates
+ * once per second.
+ */
+extern uint16_t statsEventCount;
+extern uint16_t statsFrameCount;
+extern uint32_t statsLoopTime;      // longest loop time in ticks in the current second
+extern uint32_t statsDecodeTime;    // longest consumed event processing time in ticks in the current second
+extern uint32_t statsEventQueueTime;    // longest event dispatch queue wait in ticks in the current second
+extern uint32_t statsConfigQueueTime;   // longest configuration dispatch queue wait in ticks in the current second
+extern uint32_t statsRenderTime;        // longest frame render time in ticks in the current second
+extern uint16_t statsFilterRejects;
+extern uint16_t statsFilterPasses;
+
+#endif
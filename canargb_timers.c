@@ -0,0 +1,169 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB delayed instruction timer wheel.
+ * Each slot of the wheel holds a list of the instructions which are due when
+ * the wheel reaches that slot. Unused entries are kept on a free list.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#include <xc.h>
+#include "module.h"
+#include "vlcb.h"
+#include "ticktime.h"
+#include "canargb_timers.h"
+#include "canargb_events.h"
+#include "canargb_leds.h"
+#include "canargb_service.h"
+
+#define TIMER_NONE      0xFF
+
+typedef struct {
+    uint8_t next;           // next entry in the slot or free list
+    uint8_t action;
+    uint8_t start;
+    uint8_t end;
+    uint8_t colour;
+    uint16_t rounds;        // remaining turns of the wheel before the instruction is due
+} TimerEntry;
+
+static TimerEntry timers[TIMER_CAPACITY];
+static uint8_t wheel[TIMER_WHEEL_SLOTS];
+static uint8_t freeList;
+static uint8_t currentSlot;
+static uint8_t timersInUse;
+static TickValue wheelTime;
+
+static void advanceWheel(void);
+
+/**
+ * Empty the wheel and put all the entries on the free list.
+ */
+void initTimers(void) {
+    uint8_t i;
+    
+    for (i=0; i<TIMER_WHEEL_SLOTS; i++) {
+        wheel[i] = TIMER_NONE;
+    }
+    for (i=0; i<TIMER_CAPACITY; i++) {
+        timers[i].next = i+1;
+    }
+    timers[TIMER_CAPACITY-1].next = TIMER_NONE;
+    freeList = 0;
+    currentSlot = 0;
+    timersInUse = 0;
+    wheelTime.val = tickGet();
+}
+
+/**
+ * Schedule an instruction to be performed after a delay.
+ * 
+ * @param delay the delay in TIMER_TICK units, at least 1
+ * @param action the instruction action
+ * @param start the instruction start EV
+ * @param end the instruction end EV
+ * @param colour the instruction colour EV
+ * @return TRUE if scheduled, FALSE if the wheel is full
+ */
+uint8_t scheduleInstruction(uint16_t delay, uint8_t action, uint8_t start, uint8_t end, uint8_t colour) {
+    uint8_t i;
+    uint8_t slot;
+    
+    if (freeList == TIMER_NONE) {
+        canargbDiagnostics[CANARGB_DIAG_TIMER_OVERFLOWS].asUint++;
+        return FALSE;
+    }
+    i = freeList;
+    freeList = timers[i].next;
+    
+    timers[i].action = action;
+    timers[i].start = start;
+    timers[i].end = end;
+    timers[i].colour = colour;
+    timers[i].rounds = (delay-1) / TIMER_WHEEL_SLOTS;
+    slot = (uint8_t)((currentSlot + delay) & (TIMER_WHEEL_SLOTS-1));
+    timers[i].next = wheel[slot];
+    wheel[slot] = i;
+    
+    timersInUse++;
+    canargbDiagnostics[CANARGB_DIAG_TIMERS_IN_USE].asUint = timersInUse;
+    if (timersInUse > canargbDiagnostics[CANARGB_DIAG_TIMERS_HIGH_WATER].asUint) {
+        canargbDiagnostics[CANARGB_DIAG_TIMERS_HIGH_WATER].asUint = timersInUse;
+    }
+    return TRUE;
+}
+
+/**
+ * Advance the wheel once per TIMER_TICK. The wheel time is stepped rather 
+ * than reset so that the delays don't drift.
+ */
+void pollTimers(void) {
+    while (tickTimeSince(wheelTime) >= TIMER_TICK) {
+        wheelTime.val += TIMER_TICK;
+        advanceWheel();
+    }
+}
+
+/**
+ * Move to the next slot and perform the instructions in it which are due on
+ * this turn of the wheel.
+ */
+static void advanceWheel(void) {
+    uint8_t i;
+    uint8_t next;
+    uint8_t * link;
+    uint8_t fired;
+    
+    currentSlot = (currentSlot + 1) & (TIMER_WHEEL_SLOTS-1);
+    fired = FALSE;
+    link = &wheel[currentSlot];
+    for (i = *link; i != TIMER_NONE; i = next) {
+        next = timers[i].next;
+        if (timers[i].rounds) {
+            timers[i].rounds--;
+            link = &timers[i].next;
+            continue;
+        }
+        *link = next;
+        performInstruction(timers[i].action, timers[i].start, timers[i].end, timers[i].colour);
+        timers[i].next = freeList;
+        freeList = i;
+        timersInUse--;
+        fired = TRUE;
+    }
+    if (fired) {
+        canargbDiagnostics[CANARGB_DIAG_TIMERS_IN_USE].asUint = timersInUse;
+        updateRGB();
+    }
+}
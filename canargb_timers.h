@@ -0,0 +1,58 @@
+/*
+  This work is licensed under the:
+      Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit:
+      http://creativecommons.org/licenses/by-nc-sa/4.0/
+   or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+
+   License summary:
+    You are free to:
+      Share, copy and redistribute the material in any medium or format
+      Adapt, remix, transform, and build upon the material
+
+    The licensor cannot revoke these freedoms as long as you follow the license terms.
+
+    Attribution : You must give appropriate credit, provide a link to the license,
+                   and indicate if changes were made. You may do so in any reasonable manner,
+                   but not in any way that suggests the licensor endorses you or your use.
+
+    NonCommercial : You may not use the material for commercial purposes. **(see note below)
+
+    ShareAlike : If you remix, transform, or build upon the material, you must distribute
+                  your contributions under the same license as the original.
+
+    No additional restrictions : You may not apply legal terms or technological measures that
+                                  legally restrict others from doing anything the license permits.
+
+   ** For commercial use, please contact the original copyright holder(s) to agree licensing terms
+
+    This software is distributed in the hope that it will be useful, but WITHOUT ANY
+    WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE
+ */
+/**
+ *	The CANARGB delayed instruction timer wheel.
+ *
+ * @author Ian Hogg 
+ * @date April 2025
+ * 
+ */ 
+#ifndef _CANARGB_TIMERS_H_
+#define _CANARGB_TIMERS_H_
+
+#include "vlcb.h"
+
+/*
+ * Delayed instructions are held in a timer wheel of TIMER_WHEEL_SLOTS slots 
+ * which advances every TIMER_TICK. Instructions with a delay longer than one
+ * turn of the wheel wait for the required number of turns. At most 
+ * TIMER_CAPACITY instructions can be pending.
+ */
+#define TIMER_TICK              HUNDRED_MILI_SECOND
+#define TIMER_WHEEL_SLOTS       64      // must be a power of 2
+#define TIMER_CAPACITY          32
+
+extern void initTimers(void);
+extern void pollTimers(void);
+extern uint8_t scheduleInstruction(uint16_t delay, uint8_t action, uint8_t start, uint8_t end, uint8_t colour);
+
+#endif
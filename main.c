@@ -64,6 +64,12 @@
 #include "canargb_nvs.h"
 #include "canargb_events.h"
 #include "canargb_leds.h"
+#include "canargb_service.h"
+#include "canargb_flash.h"
+#include "canargb_dispatch.h"
+#include "canargb_layers.h"
+#include "canargb_journal.h"
+#include "canargb_bench.h"
 
 /**************************************************************************
  * Application code packed with the bootloader must be compiled with options:
@@ -102,12 +108,25 @@ void initialise(void);
 void factoryResetGlobalEvents(void);
 
 
-static TickValue   flashTime;
 static TickValue   testTime;
+static TickValue   loopTime;
 static TickValue   subtestTime;
+#ifdef LOW_POWER_IDLE
+static TickValue   idleWindowTime;
+static uint32_t    idleTicks;
+static uint16_t    idleWakeups;
+
+static void initIdle(void);
+static void idle(void);
+#endif
 
 
+/*
+ * canargbService is first so that its powerUp can get the string dark as early
+ * as possible.
+ */
 const Service * const services[] = {
+    &canargbService,
     &canService,
     &mnsService,
     &nvService,
@@ -128,18 +147,20 @@ void APP_factoryReset(void) {
     factoryResetGlobalEvents();
 }
 
-#define NUM_TESTS 6
+#define NUM_TESTS 7
 /**
  * Called if the PB is held down during power up.
  * Normally would perform any test functionality to help a builder check the hardware.
  * Goes through a number of different tests, each lasting a few seconds and then repeats
- * indefinately. Function does not end.
+ * indefinately. The last test runs the throughput benchmark and sends the results
+ * as DGN messages. Function does not end.
  */
 void APP_testMode(void) {
     uint8_t step;
     uint8_t i,c;
     
     initARGB();
+    initLayers();   // the benchmark performs event instructions
     ANSELA = 0x00;
     ANSELB = 0x00;
     ANSELC = 0x00;
@@ -169,7 +190,7 @@ void APP_testMode(void) {
                 case 3:
                     updateLedRange(0, MAX_LEDS-1, (PaletteIndex)((uint8_t)0x00));   // all black
                     for (i=0,c=1; i<255; i++) {     // each led a different colour
-                        ledPaletteIndexes[i].asByte = c;
+                        updateLedRange(i, i, (PaletteIndex)c);
                         c++;
                         if (c >= 0x10) c=1;
                     }
@@ -194,15 +215,23 @@ void APP_testMode(void) {
                     i=0;
                     subtestTime.val = tickGet();
                     break;
+                case 6: // benchmark, results in the diagnostics and sent as DGN
+                    runBenchmark();
+                    testTime.val = tickGet();
+                    break;
             }
+            updateRGB();
         }
         if (step == 5) {    // animate
             if (tickTimeSince(subtestTime) > HUNDRED_MILI_SECOND) {
                 subtestTime.val = tickGet();
                 updateLedRange(i,i, (PaletteIndex)((uint8_t)0xFF));   // update next in string to white
+                updateRGB();
                 i++;
             }
         }
+        pollRender();
+        refreshString();
     }
 }
 
@@ -210,8 +239,8 @@ void APP_testMode(void) {
  * Called upon power up.
  */
 void setup(void) {
-    // use CAN as the module's transport
-    transport = &canTransport;
+    // use CAN as the module's transport, received messages are prioritised
+    transport = &dispatchTransport;
 
     /**
      * The order of initialisation is important.
@@ -219,14 +248,24 @@ void setup(void) {
     setTimedResponseDelay(5);
     
     initARGB();
+    initLayers();
+    initJournal();
+    replayJournal();
 
     ANSELA = 0x00;
     ANSELB = 0x00;
     ANSELC = 0x00;
+    if (getNV(NV_SELF_TEST)) {
+        requestSelfTest();
+    }
 
+#ifdef LOW_POWER_IDLE
+    initIdle();
+#endif
     // enable interrupts, all init now done
     ei(); 
-    flashTime.val = tickGet();
+    initFlash();
+    loopTime.val = tickGet();
     if (0) {
         updateLedRange(0, 2, (PaletteIndex)(uint8_t)0x00);  // black/off
         updateLedRange(3, 5, (PaletteIndex)(uint8_t)0x11);  // dark grey
@@ -252,15 +291,97 @@ void setup(void) {
 }
 
 void loop(void) {
+    uint32_t t;
+    
     // Check and do flashing
-    if (tickTimeSince(flashTime) > HALF_SECOND) {
-        doFlash();
-        flashTime.val = tickGet();
-    }
+    pollFlash();
     // Keep the LEDs up to date.
+    pollRender();
     refreshString();
+    // Time since the end of the last loop, which includes the VLCB poll()
+    t = tickTimeSince(loopTime);
+    if (t > statsLoopTime) statsLoopTime = t;
+#ifdef LOW_POWER_IDLE
+    idle();
+#endif
+    loopTime.val = tickGet();
+}
+
+#ifdef LOW_POWER_IDLE
+/**
+ * Set up TMR6 as the frame timer used to wake the CPU from IDLE. It gives a
+ * period of IDLE_WAKE_PERIOD_US which bounds the latency of the VLCB poll
+ * activities which are driven from tickGet().
+ */
+static void initIdle(void) {
+    T6CLKCON = 0x01;        // Fosc/4 clock source
+    T6HLT = 0x00;           // free running, software gate
+    T6PR = (IDLE_WAKE_PERIOD_US/8)-1;   // 1:128 prescalar gives 8us per count
+    T6CON = 0xF0;           // ON, 1:128 prescalar, 1:1 postscalar
+    PIE15bits.TMR6IE = 0;
+    CPUDOZEbits.IDLEN = 1;  // SLEEP instruction enters IDLE rather than SLEEP
+    idleTicks = 0;
+    idleWakeups = 0;
+    idleWindowTime.val = tickGet();
 }
 
+/**
+ * Park the CPU in IDLE if there is nothing to do until the next frame timer
+ * period. The peripherals, including the SPI/DMA string output, keep running.
+ * Interrupts are disabled so that the wakeup sources don't need an ISR: the 
+ * CPU continues after the SLEEP instruction and the wakeup interrupt enables
+ * are cleared again before interrupts are re-enabled.
+ * Wakes on CAN receive, DMA string transfer complete, TMR6 frame timer or the
+ * TMR0 tick.
+ */
+static void idle(void) {
+    TickValue idleStart;
+    
+    if (tickTimeSince(idleWindowTime) >= ONE_SECOND) {
+        canargbDiagnostics[CANARGB_DIAG_IDLE_FRACTION].asUint = (uint16_t)((idleTicks * 1000) / tickTimeSince(idleWindowTime));
+        canargbDiagnostics[CANARGB_DIAG_IDLE_WAKEUPS].asUint = idleWakeups;
+        idleTicks = 0;
+        idleWakeups = 0;
+        idleWindowTime.val = tickGet();
+    }
+    // is anything due?
+    if (refreshPending()) return;
+    if (dispatchPending()) return;
+#ifndef DMA
+    if (outputBusy()) return;   // the string is fed from the SPI1TX interrupt
+#endif
+    if (flashDue()) return;
+    if (timedResponseInProgress()) return;
+    
+    di();
+    if (C1FIFOSTA3Lbits.TFNRFNIF) {
+        // CAN message waiting to be processed
+        ei();
+        return;
+    }
+    TMR6 = 0;
+    PIR15bits.TMR6IF = 0;
+    PIE15bits.TMR6IE = 1;
+    PIR2bits.DMA1SCNTIF = 0;
+    PIE2bits.DMA1SCNTIE = 1;
+    C1FIFOCON3Lbits.TFNRFNIE = 1;
+    C1INTUbits.RXIE = 1;
+    idleStart.val = tickGet();
+    
+    SLEEP();
+    NOP();
+    
+    C1INTUbits.RXIE = 0;
+    C1FIFOCON3Lbits.TFNRFNIE = 0;
+    PIE2bits.DMA1SCNTIE = 0;
+    PIE15bits.TMR6IE = 0;
+    PIR15bits.TMR6IF = 0;
+    idleTicks += tickTimeSince(idleStart);
+    idleWakeups++;
+    ei();
+}
+#endif
+
 // Application functions required by VLCB library
 
 
@@ -275,7 +396,11 @@ void loop(void) {
 ValidTime APP_isSuitableTimeToWriteFlash(void){
 #ifdef DMA
     if (DMAnCON0bits.DGO) return BAD_TIME;
+#else
+    // the CPU stalls during a flash write so the SPI1TX interrupt can't keep up
+    if (outputBusy()) return BAD_TIME;
 #endif
+    if (journalBusy()) return BAD_TIME;
     return GOOD_TIME;
 }
 
@@ -13,7 +13,7 @@
 //
 // The data version stored at NV#0
 #define APP_NVM_VERSION 1
-#define NUM_SERVICES 6
+#define NUM_SERVICES 7
 
 
 #if defined(_18FXXQ83_FAMILY_)
@@ -26,10 +26,16 @@
 //
 // NV service
 //
-#define NV_NUM          49
+#define NV_NUM          203
 #define NV_ADDRESS      0x200
 #define NV_NVM_TYPE     EEPROM_NVM_TYPE
 
+//
+// LED state journal, in the EEPROM below the NVs
+//
+#define JOURNAL_ADDRESS 0x000
+#define JOURNAL_SIZE    0x200
+
 #define NV_CACHE
 
 //
@@ -121,6 +127,9 @@
 
 // Module specific stuff here
 #define DMA
+// Park the CPU in IDLE between frames. The frame timer wakes at least every IDLE_WAKE_PERIOD_US
+#define LOW_POWER_IDLE
+#define IDLE_WAKE_PERIOD_US     1000
 
 
 #endif
\ No newline at end of file